@@ -15,6 +15,25 @@
 #include <limits.h>
 #include <string.h>
 #include <queue>
+#include <cmath>
+#include <csignal>
+#include <chrono>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sstream>
+#include <cerrno>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 using namespace std;
 
 
@@ -29,6 +48,37 @@ const int MLC = 10; //Maximum Link Capacity
 const int SRCID = 52; //Source Node ID used for network
 const int DSTID = 725; //Destination Node ID used for network
 const int ITV = 50; //Intervals between flow recordings
+const int POLICY_RANDOM = 0; //ID of RandomRepair in result files
+const int POLICY_GREEDY = 1; //ID of GreedyRepair in result files
+const int POLICY_GAIN = 2; //ID of GainRepair in result files
+const int POLICIES = 3; //Number of repair policies
+const string POLICY_NAME[POLICIES] = {"Random", "Greedy", "Gain"};
+const string POLICY_TAG[POLICIES] = {"R", "A", "G"}; //Column tags in output
+const char CHECKPOINT_MAGIC[8] = {'S','N','R','C','K','P','7','\0'};
+const int CKPT_SECONDS = 60; //Seconds between sweep checkpoints
+const int ADAPT_BATCH = 8; //Trials per batch in adaptive sweeps
+const int ADAPT_MIN = 16; //Trials run before an adaptive sweep may stop
+const double CI_Z = 1.96; //Normal quantile of a 95% confidence interval
+const int AFTERSHOCK_SHARE = 4; //Aftershocks break 1/4 as much as the failure
+const int OVERLOAD_PCT = 30; //Chance that a Link trips once flow fills it
+const int GAIN_SHARE = 32; //Fewest candidates worth a GainRepair thread
+const int PIPE_DEPTH = 8; //Sweep scenarios in flight beyond one per worker
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////GLOBAL VARIABLES////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+atomic<int> interrupted(0); //Set when a sweep is interrupted. Lock-free, so
+//it is safe in a signal handler and may be read from any thread
+
+///////////////////////////////////////////////////////////////////////////////
+/////////////////////////////FUNCTION PROTOTYPES///////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+template <class Cap>
+bool bfs(Cap** RG, int s, int t, int* parent, int nodes, bool* reach = NULL);
+template <class Cap> int calcMaxFlow(Cap** graph, int s, int t, int nodes);
+void backoff(const int n);
 
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////CLASSES/////////////////////////////////////
@@ -104,662 +154,4118 @@ class Link
     
 };
 
-/////////////
-///NETWORK///
-/////////////
+////////////////////
+///FAILURE KERNEL///
+////////////////////
 
-class Network
+//Description: Works out which components a failure breaks. The coordinates of
+//every Node and Link midpoint are kept in separate arrays, so a kernel can
+//test 4 (SSE2) or 8 (AVX2) components with each instruction, and the result
+//is written straight into bitsets: bit i%64 of word i/64 is set when
+//component i breaks. Random failures use a counter-based generator, so the
+//draw for a component depends only on the seed and the component's index.
+//Coordinates never change once the Network is parsed, so every copy of a
+//Network shares them, and only the masks belong to each copy.
+class FailureKernel
 {
   public:
-    int node_count; //Number of Nodes
-    int link_count; //Number of Links
-    int nodes_broken; //Number of broken Nodes
-    int links_broken; //Number of broken Links
-    int** AM; //Adjacency Matrix for graphical representation of this Network
-    vector<Node> v_node; //Stores all Nodes in the network
-    vector<Link> v_link; //Stores all Links in the network
-    int RRT; //Remaining Repair Time. Stores remaining amount of time until
-    //a scheduled repair is completed
-    bool LR; //Link Repair. 1 if a single Link is to be repaired
-    bool NR; //Node Repair. 1 is a single Node is to be repaired
-    bool SR; //Smart Repair. 1 if a smart repair is scheduled.
-    int RI; //Repair Index. Stores index of item to be repaired.
-    float b_x; //Barycenter's X-Coordinate
-    float b_y; //Barycenter's Y-Coordinate
-        
-    //CONSTRUCTOR
-    Network()
+    //Description: Coordinates of every component. Arrays are padded to a
+    //whole number of mask words so kernels never need a scalar tail.
+    struct Coords
     {
-      node_count = 0;
-      link_count = 0;
-      nodes_broken = 0;
-      links_broken = 0;
-      RRT = 0;
-      LR = false;
-      NR = false;
-      SR = false;
-      RI = -1;
-      AM = NULL;
+      int n_count; //Number of Nodes
+      int l_count; //Number of Links
+      vector<float> n_x; //X-Coordinate of every Node
+      vector<float> n_y; //Y-Coordinate of every Node
+      vector<float> l_x; //X-Coordinate of every Link's midpoint
+      vector<float> l_y; //Y-Coordinate of every Link's midpoint
+    };
+
+    shared_ptr<const Coords> coords; //Shared by all copies, NULL until built
+    vector<uint64_t> n_mask; //Nodes broken by the last failure
+    vector<uint64_t> l_mask; //Links broken by the last failure
+
+    //BUILD
+    //Description: Copies the coordinates out of the Nodes and Links.
+    void build(vector<Node> & nodes, vector<Link> & links)
+    {
+      Coords* c = new Coords;
+      c->n_count = nodes.size();
+      c->l_count = links.size();
+      c->n_x.assign(words(c->n_count) * 64, 0);
+      c->n_y.assign(words(c->n_count) * 64, 0);
+      c->l_x.assign(words(c->l_count) * 64, 0);
+      c->l_y.assign(words(c->l_count) * 64, 0);
+      for (int i = 0; i < c->n_count; i++)
+      {
+        c->n_x[i] = nodes[i].getXP();
+        c->n_y[i] = nodes[i].getYP();
+      }
+      for (int i = 0; i < c->l_count; i++)
+      {
+        c->l_x[i] = links[i].getMX();
+        c->l_y[i] = links[i].getMY();
+      }
+      coords.reset(c);
+      n_mask.assign(words(c->n_count), 0);
+      l_mask.assign(words(c->l_count), 0);
+      return;
     }
-    
-    //COPY CONSTRUCTOR
-    Network(Network & rhs)
+
+    //RANDOM MASK
+    //Description: Every component breaks with probability percent/100.
+    //Nodes and Links draw from separate streams of the same seed.
+    void randomMask(const uint32_t seed, const int percent)
     {
-      node_count = rhs.node_count;
-      link_count = rhs.link_count;
-      nodes_broken = rhs.nodes_broken;
-      links_broken = rhs.links_broken;
-      AM = new int*[node_count];
-      for (int i = 0; i < node_count; i++)
+      randomBits(n_mask, coords->n_count, hash32(seed*2), percent);
+      randomBits(l_mask, coords->l_count, hash32(seed*2 + 1), percent);
+      return;
+    }
+
+    //GEOGRAPHIC MASK
+    //Description: Components closer to (cx, cy) than the passed % of the
+    //radius, squared, of the circle around (cx, cy) that holds every Node
+    //break. Distances are truncated to integers before the comparison, as
+    //the original scalar loop did.
+    void geoMask(const float cx, const float cy, const float percent)
+    {
+      const Coords & c = *coords;
+      float limit = (percent/100) * maxDistance(c, cx, cy);
+      geoBits(n_mask, c.n_x, c.n_y, c.n_count, cx, cy, limit);
+      geoBits(l_mask, c.l_x, c.l_y, c.l_count, cx, cy, limit);
+      return;
+    }
+
+    //TEST
+    //Description: Returns true if bit i of the mask is set.
+    static bool test(const vector<uint64_t> & mask, const int i)
+    {
+      return (mask[i / 64] >> (i % 64)) & 1;
+    }
+
+    //HASH
+    //Description: Bijective 32-bit integer hash. Every kernel below computes
+    //the same function, so results do not depend on the instruction set.
+    static uint32_t hash32(uint32_t x)
+    {
+      x ^= x >> 16;
+      x *= 0x7feb352d;
+      x ^= x >> 15;
+      x *= 0x846ca68b;
+      x ^= x >> 16;
+      return x;
+    }
+
+  private:
+    //WORDS
+    //Description: Number of 64-bit mask words needed for count components.
+    static int words(const int count)
+    {
+      return (count + 63) / 64;
+    }
+
+    //CLEAR TAIL
+    //Description: Clears the bits of the padding past the last component.
+    static void clearTail(vector<uint64_t> & mask, const int count)
+    {
+      if (count % 64 != 0)
       {
-        AM[i] = new int[node_count];
-        for (int j = 0; j < node_count; j++)
+        mask[count / 64] &= (1ULL << (count % 64)) - 1;
+      }
+      return;
+    }
+
+    //RANDOM BITS
+    //Description: Sets bit i when hash32(i + key) falls below the threshold
+    //for the passed %.
+    static void randomBits(vector<uint64_t> & mask, const int count,
+                           const uint32_t key, const int percent)
+    {
+      if (percent <= 0 || percent >= 100)
+      {
+        mask.assign(words(count), percent <= 0 ? 0 : ~0ULL);
+        clearTail(mask, count);
+        return;
+      }
+      uint32_t limit = (static_cast<uint64_t>(percent) << 32) / 100;
+#if defined(__AVX2__)
+      const __m256i sign = _mm256_set1_epi32(INT_MIN);
+      const __m256i lim = _mm256_xor_si256(_mm256_set1_epi32(limit), sign);
+      const __m256i m1 = _mm256_set1_epi32(0x7feb352d);
+      const __m256i m2 = _mm256_set1_epi32(0x846ca68b);
+      __m256i idx = _mm256_add_epi32(_mm256_set1_epi32(key),
+                                     _mm256_setr_epi32(0,1,2,3,4,5,6,7));
+      for (int w = 0; w < words(count); w++)
+      {
+        uint64_t bits = 0;
+        for (int j = 0; j < 64; j += 8)
         {
-          AM[i][j] = rhs.AM[i][j];
+          __m256i x = idx;
+          x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+          x = _mm256_mullo_epi32(x, m1);
+          x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+          x = _mm256_mullo_epi32(x, m2);
+          x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+          __m256i lt = _mm256_cmpgt_epi32(lim, _mm256_xor_si256(x, sign));
+          bits |= static_cast<uint64_t>(
+                    _mm256_movemask_ps(_mm256_castsi256_ps(lt))) << j;
+          idx = _mm256_add_epi32(idx, _mm256_set1_epi32(8));
         }
+        mask[w] = bits;
       }
-      for (int i = 0; i < node_count; i++)
+#elif defined(__SSE2__)
+      const __m128i sign = _mm_set1_epi32(INT_MIN);
+      const __m128i lim = _mm_xor_si128(_mm_set1_epi32(limit), sign);
+      const __m128i m1 = _mm_set1_epi32(0x7feb352d);
+      const __m128i m2 = _mm_set1_epi32(0x846ca68b);
+      __m128i idx = _mm_add_epi32(_mm_set1_epi32(key),
+                                  _mm_setr_epi32(0,1,2,3));
+      for (int w = 0; w < words(count); w++)
       {
-        v_node.push_back(rhs.v_node[i]);
+        uint64_t bits = 0;
+        for (int j = 0; j < 64; j += 4)
+        {
+          __m128i x = idx;
+          x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+          x = mullo(x, m1);
+          x = _mm_xor_si128(x, _mm_srli_epi32(x, 15));
+          x = mullo(x, m2);
+          x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+          __m128i lt = _mm_cmplt_epi32(_mm_xor_si128(x, sign), lim);
+          bits |= static_cast<uint64_t>(
+                    _mm_movemask_ps(_mm_castsi128_ps(lt))) << j;
+          idx = _mm_add_epi32(idx, _mm_set1_epi32(4));
+        }
+        mask[w] = bits;
       }
-      for (int i = 0; i < link_count; i++)
+#else
+      for (int w = 0; w < words(count); w++)
       {
-        v_link.push_back(rhs.v_link[i]);
+        uint64_t bits = 0;
+        for (int j = 0; j < 64; j++)
+        {
+          uint32_t x = hash32(w*64 + j + key);
+          bits |= static_cast<uint64_t>(x < limit) << j;
+        }
+        mask[w] = bits;
       }
-      RRT = rhs.RRT;
-      LR = rhs.LR;
-      NR = rhs.NR;
-      SR = rhs.SR;
-      RI = rhs.RI;
-      b_x = rhs.b_x;
-      b_y = rhs.b_y;
+#endif
+      clearTail(mask, count);
+      return;
     }
-    
-    //DESTRUCTOR
-    ~Network()
+
+    //MAX DISTANCE
+    //Description: Largest distance, squared, from (cx, cy) to any Node.
+    static float maxDistance(const Coords & c, const float cx,
+                             const float cy)
     {
-      for (int i = 0; i < node_count; i++)
+      const vector<float> & n_x = c.n_x;
+      const vector<float> & n_y = c.n_y;
+      int n_count = c.n_count;
+      float rmax = -1;
+      int i = 0;
+#if defined(__SSE2__)
+      const __m128 vx = _mm_set1_ps(cx);
+      const __m128 vy = _mm_set1_ps(cy);
+      __m128 vmax = _mm_set1_ps(-1);
+      for (; i + 4 <= n_count; i += 4)
       {
-        delete []AM[i];
+        __m128 dx = _mm_sub_ps(vx, _mm_loadu_ps(&n_x[i]));
+        __m128 dy = _mm_sub_ps(vy, _mm_loadu_ps(&n_y[i]));
+        __m128 d = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        vmax = _mm_max_ps(vmax, d);
       }
-      delete []AM;
+      float lanes[4];
+      _mm_storeu_ps(lanes, vmax);
+      for (int j = 0; j < 4; j++)
+      {
+        rmax = max(rmax, lanes[j]);
+      }
+#endif
+      for (; i < n_count; i++)
+      {
+        float dx = cx - n_x[i];
+        float dy = cy - n_y[i];
+        rmax = max(rmax, dx*dx + dy*dy);
+      }
+      return rmax;
     }
-    
-    //ACCESSOR FUNCTIONS
-    int getNC(){return node_count;}
-    int getLC(){return link_count;}
-    int getNB(){return nodes_broken;}
-    int getLB(){return links_broken;}
 
-    //ASSESS DAMAGE
-    //Description: Returns the time required to fix the entire network
-    int assessDamage()
+    //GEOGRAPHIC BITS
+    //Description: Sets bit i when the truncated distance, squared, from
+    //(cx, cy) to component i is below limit.
+    static void geoBits(vector<uint64_t> & mask, const vector<float> & xs,
+                        const vector<float> & ys, const int count,
+                        const float cx, const float cy, const float limit)
     {
-      int duration = 0; //Stores time required to fix entire network
-      for (int i = 0; i < node_count; i++)
+#if defined(__AVX2__)
+      const __m256 vx = _mm256_set1_ps(cx);
+      const __m256 vy = _mm256_set1_ps(cy);
+      const __m256 lim = _mm256_set1_ps(limit);
+      for (int w = 0; w < words(count); w++)
       {
-        if (v_node[i].broken)
+        uint64_t bits = 0;
+        for (int j = 0; j < 64; j += 8)
         {
-          duration += v_node[i].getTIME();
+          __m256 dx = _mm256_sub_ps(vx, _mm256_loadu_ps(&xs[w*64 + j]));
+          __m256 dy = _mm256_sub_ps(vy, _mm256_loadu_ps(&ys[w*64 + j]));
+          __m256 d = _mm256_add_ps(_mm256_mul_ps(dx, dx),
+                                   _mm256_mul_ps(dy, dy));
+          d = _mm256_cvtepi32_ps(_mm256_cvttps_epi32(d));
+          __m256 lt = _mm256_cmp_ps(d, lim, _CMP_LT_OQ);
+          bits |= static_cast<uint64_t>(_mm256_movemask_ps(lt)) << j;
         }
+        mask[w] = bits;
       }
-      for (int j = 0; j < link_count; j++)
+#elif defined(__SSE2__)
+      const __m128 vx = _mm_set1_ps(cx);
+      const __m128 vy = _mm_set1_ps(cy);
+      const __m128 lim = _mm_set1_ps(limit);
+      for (int w = 0; w < words(count); w++)
       {
-        if (v_link[j].broken)
+        uint64_t bits = 0;
+        for (int j = 0; j < 64; j += 4)
         {
-          duration += v_link[j].getTIME();
+          __m128 dx = _mm_sub_ps(vx, _mm_loadu_ps(&xs[w*64 + j]));
+          __m128 dy = _mm_sub_ps(vy, _mm_loadu_ps(&ys[w*64 + j]));
+          __m128 d = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+          d = _mm_cvtepi32_ps(_mm_cvttps_epi32(d));
+          bits |= static_cast<uint64_t>(
+                    _mm_movemask_ps(_mm_cmplt_ps(d, lim))) << j;
         }
+        mask[w] = bits;
       }
-      return duration;
+#else
+      for (int w = 0; w < words(count); w++)
+      {
+        uint64_t bits = 0;
+        for (int j = 0; j < 64; j++)
+        {
+          float dx = cx - xs[w*64 + j];
+          float dy = cy - ys[w*64 + j];
+          int temp = dx*dx + dy*dy;
+          bits |= static_cast<uint64_t>(temp < limit) << j;
+        }
+        mask[w] = bits;
+      }
+#endif
+      clearTail(mask, count);
+      return;
     }
 
-    //REPAIR NODE
-    //Description: Schedules a Node to be repaired
-    void repairNode(const int index)
+#if defined(__SSE2__) && !defined(__AVX2__)
+    //MULLO
+    //Description: Low 32 bits of each lane's product. SSE2 has no single
+    //instruction for it, so even and odd lanes are multiplied separately.
+    static __m128i mullo(const __m128i a, const __m128i b)
     {
-      if (RRT != 0 && !v_node[index].broken)
+#if defined(__SSE4_1__)
+      return _mm_mullo_epi32(a, b);
+#else
+      __m128i even = _mm_mul_epu32(a, b);
+      __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+      return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0,0,2,0)),
+                                _mm_shuffle_epi32(odd, _MM_SHUFFLE(0,0,2,0)));
+#endif
+    }
+#endif
+};
+
+////////////////
+///FLOW STATE///
+////////////////
+
+//Description: Keeps a Max Flow and its residual graph between calls, so the
+//flow can be brought up to date when capacities change instead of being
+//calculated from zero. While capacities only grow, the old flow stays valid
+//and only the new augmenting paths have to be found. When a capacity shrinks
+//below the flow it carries, only the flow that no longer fits is cancelled
+//and routed again.
+template <class Cap>
+class FlowState
+{
+  public:
+    int nodes; //Number of nodes in the graph
+    int src; //Source node
+    int dst; //Destination node
+    int value; //Current flow from src to dst
+    Cap** CG; //Capacity Graph the current flow was calculated for
+    Cap** RG; //Residual Graph of the current flow
+    int* parent; //Parent array used by bfs()
+    vector<int> x_from; //Nodes left with extra flow by cancelled flow
+    vector<int> x_to; //Nodes left short of flow by cancelled flow
+    vector<int> x_amt; //Amount of each cancelled flow
+
+    //CONSTRUCTOR
+    //Description: Calculates the Max Flow of the passed graph.
+    FlowState(Cap** graph, int n, int s, int t)
+    {
+      nodes = n;
+      src = s;
+      dst = t;
+      value = 0;
+      CG = new Cap*[nodes];
+      RG = new Cap*[nodes];
+      for (int i = 0; i < nodes; i++)
       {
-        cout << "Error, Illegal use of Repair()" << endl;
-        return;
+        CG[i] = new Cap[nodes];
+        RG[i] = new Cap[nodes];
+        for (int j = 0; j < nodes; j++)
+        {
+          CG[i][j] = graph[i][j];
+          RG[i][j] = graph[i][j];
+        }
       }
-      NR = true;
-      RI = index;
-      RRT = v_node[index].getTIME();
-      return;
+      parent = new int[nodes];
+      value = augment();
     }
 
-    //REPAIR LINK
-    //Description: Schedules a Link to be repaired
-    void repairLink(const int index)
+    //COPY CONSTRUCTOR
+    FlowState(FlowState & rhs)
     {
-      if (RRT != 0 || !v_link[index].broken)
+      nodes = rhs.nodes;
+      src = rhs.src;
+      dst = rhs.dst;
+      CG = new Cap*[nodes];
+      RG = new Cap*[nodes];
+      for (int i = 0; i < nodes; i++)
       {
-        cout << "Error, Illegal use of Repair()" << endl;
-        return;
+        CG[i] = new Cap[nodes];
+        RG[i] = new Cap[nodes];
       }
-      LR = true;
-      RI = index;
-      RRT = v_link[index].getTIME();
-      return;
+      parent = new int[nodes];
+      copyFrom(rhs);
     }
 
-    //SMART REPAIR TIME CALCULATOR
-    //Description: Evaluates the required time to repair a Link and its two
-    //related Nodes.
-    int calcSRT(const int index)
+    //DESTRUCTOR
+    ~FlowState()
     {
-      int SRT = 0;
-      if (v_link[index].broken)
+      for (int i = 0; i < nodes; i++)
       {
-        SRT += v_link[index].getTIME();
+        delete []CG[i];
+        delete []RG[i];
       }
-      if (v_node[v_link[index].getSI()].broken) //Link's first node is broken
-      {
-        SRT += v_node[v_link[index].getSI()].getTIME(); //Add more repair time
-      }   
-      if (v_node[v_link[index].getEI()].broken) //If other node is broken
-      {
-        SRT += v_node[v_link[index].getEI()].getTIME();
-      } 
-      return SRT;
+      delete []CG;
+      delete []RG;
+      delete []parent;
     }
 
-    //SMART REPAIR
-    //Description: Schedules a Link to be repaired, and if either of the nodes
-    //attached to that Link are broken, they are scheduled to be repaired too.
-    void smartRepair(const int index)
+    //COPY FROM
+    //Description: Overwrites this flow with another flow on a graph of the
+    //same size.
+    void copyFrom(FlowState & rhs)
     {
-      if (RRT != 0 || v_link[index].connected)
+      value = rhs.value;
+      for (int i = 0; i < nodes; i++)
       {
-        cout << "Error, Illegal use of Repair()" << endl;
-        return;
+        memcpy(CG[i], rhs.CG[i], nodes*sizeof(Cap));
+        memcpy(RG[i], rhs.RG[i], nodes*sizeof(Cap));
       }
-      SR = true;
-      RI = index;
-      RRT = calcSRT(index);
       return;
     }
-    
-    //PROGRESS
-    //Description: This function decreases the remaining time on any scheduled
-    //repair. If RRT reaches zero, then the repair is completed, and the
-    //repaired objects are marked as functional.
-    void progress()
+
+    //CHANGE ARC
+    //Description: Sets the capacities of the arcs from i to j and from j to
+    //i. The flow between i and j is kept if it still fits. Otherwise, the part
+    //that does not fit is cancelled and recorded, and repairFlow() must be
+    //called before the flow is used again.
+    void changeArc(const int i, const int j, const Cap c_ij, const Cap c_ji)
     {
-      if (RRT > 0) //Repair is still being processed
-      {
-        cout << "Repair not yet completed." << endl;
-      }
-      else if (NR) //Node Repair was completed
+      int x = static_cast<int>(CG[i][j]) - RG[i][j]; //Net flow from i to j
+      CG[i][j] = c_ij;
+      CG[j][i] = c_ji;
+      if (x > c_ij) //Too much flow from i to j
       {
-        NR = false;
-        v_node[RI].broken = false;
-        nodes_broken--;
-        RI = -1;
-        connect();
+        x_from.push_back(i);
+        x_to.push_back(j);
+        x_amt.push_back(x - c_ij);
+        x = c_ij;
       }
-      else if (LR) //Link Repair was completed
+      else if (x < -static_cast<int>(c_ji)) //Too much flow from j to i
       {
-        LR = false;
-        v_link[RI].broken = false;
-        links_broken--;
-        RI = -1;
-        connect();
+        x_from.push_back(j);
+        x_to.push_back(i);
+        x_amt.push_back(-static_cast<int>(c_ji) - x);
+        x = -static_cast<int>(c_ji);
       }
-      else if (SR) //Smart Repair was completed
+      RG[i][j] = c_ij - x;
+      RG[j][i] = c_ji + x;
+      return;
+    }
+
+    //REPAIR FLOW
+    //Description: Routes the flow cancelled by changeArc() again and returns
+    //the new Max Flow. Cancelled flow is first sent around the shrunk arc.
+    //Whatever cannot be sent around it is returned to src from the node left
+    //with extra flow, and taken back from dst by the node left short. Then
+    //new augmenting paths are searched for from the repaired flow.
+    int repairFlow()
+    {
+      bool repaired = true; //False if some cancelled flow could not be routed
+      for (unsigned int k = 0; k < x_amt.size() && repaired; k++)
       {
-        SR = false;
-        int temp_s = v_link[RI].getSI();
-        int temp_e = v_link[RI].getEI();
-        if (v_node[temp_s].broken == true)
+        int a = x_from[k];
+        int b = x_to[k];
+        int rem = x_amt[k] - pushFlow(a, b, x_amt[k]);
+        if (rem > 0 && a != src && a != dst)
         {
-          v_node[temp_s].broken = false;
-          nodes_broken--;
+          repaired = (pushFlow(a, src, rem) == rem);
         }
-        if (v_node[temp_e].broken == true)
+        if (rem > 0 && b != src && b != dst && repaired)
         {
-          v_node[temp_e].broken = false;
-          nodes_broken--;
+          repaired = (pushFlow(dst, b, rem) == rem);
         }
-        if (v_link[RI].broken == true)
+      }
+      x_from.clear();
+      x_to.clear();
+      x_amt.clear();
+      if (!repaired) //Falls back on calculating the flow from zero
+      {
+        for (int i = 0; i < nodes; i++)
         {
-          v_link[RI].broken = false;
-          links_broken--;
+          memcpy(RG[i], CG[i], nodes*sizeof(Cap));
         }
-        RI = -1;
-        connect();
       }
-      else
+      value = 0;
+      for (int j = 0; j < nodes; j++) //Net flow leaving src
       {
-        cout << "Error. No repair was scheduled to be completed." << endl;
+        value += static_cast<int>(CG[src][j]) - RG[src][j];
       }
-      return;
+      value += augment();
+      return value;
     }
-    
-    //CONNECT
-    //Description: This function updates all unconnected Links.
-    void connect()
+
+    //AUGMENT
+    //Description: Pushes flow along shortest augmenting paths of the residual
+    //graph until none are left. Returns the amount of flow added.
+    int augment()
     {
-      for (int k = 0; k < link_count; k++)
+      return pushFlow(src, dst, INT_MAX);
+    }
+
+    //PUSH FLOW
+    //Description: Pushes up to limit units of flow from node a to node b
+    //along shortest paths of the residual graph. Returns the amount pushed.
+    int pushFlow(const int a, const int b, const int limit)
+    {
+      int pushed = 0;
+      while (pushed < limit && bfs(RG, a, b, parent, nodes))
       {
-        if (v_link[k].connected == false) //Link is marked as unconnected
+        int path_flow = limit - pushed;
+        for (int v = b; v != a; v = parent[v])
         {
-          if (!v_node[v_link[k].getSI()].broken &&
-              !v_node[v_link[k].getEI()].broken &&
-              !v_link[k].broken)
-          //If both nodes are functional and the link is repaired
-          {
+          path_flow = min(path_flow, static_cast<int>(RG[parent[v]][v]));
+        }
+        for (int v = b; v != a; v = parent[v])
+        {
+          RG[parent[v]][v] -= path_flow;
+          RG[v][parent[v]] += path_flow;
+        }
+        pushed += path_flow;
+      }
+      return pushed;
+    }
+
+    //REACHABLE
+    //Description: Marks every node that src can still reach in the residual
+    //graph. Those nodes form the source side of the current minimum cut.
+    void reachable(bool* reach)
+    {
+      bfs(RG, src, dst, parent, nodes, reach);
+      return;
+    }
+};
+
+///////////////////
+///REDUCED GRAPH///
+///////////////////
+
+//Description: A smaller copy of a Network's adjacency matrix that gives the
+//same Max Flow between two fixed nodes. It is built once from the full
+//topology, so it stays valid no matter which components later break:
+// - Dead-end subtrees (pendant nodes) are removed.
+// - Only the biconnected blocks lying on the s-t path are kept.
+// - Chains of degree-2 nodes are contracted into a single arc whose capacity
+//   is the smallest capacity along the chain. Parallel chains between the
+//   same two nodes share one arc, and their capacities are added.
+//Cap is the integer type used to store capacities.
+template <class Cap>
+class ReducedGraph
+{
+  public:
+    int src; //Source Node ID in the original Network
+    int dst; //Destination Node ID in the original Network
+    int r_count; //Number of nodes kept in the reduced graph
+    int r_src; //Index of the source in the reduced graph
+    int r_dst; //Index of the destination in the reduced graph
+    Cap** RAM; //Reduced Adjacency Matrix
+    vector< vector<int> > c_edge; //Original node pairs (u,v,u,v...) of chains
+    vector<int> c_arc; //Arc that each chain belongs to
+    vector<int> c_cap; //Current capacity of each chain
+    vector< vector<int> > a_chain; //Chains that make up each arc
+    vector<int> a_s; //Reduced index of each arc's first node
+    vector<int> a_e; //Reduced index of each arc's other node
+    vector<int> l_chain; //Chain holding each Link, -1 if the Link was removed
+    FlowState<Cap>* state; //Flow kept between calls to calcFlow(), or NULL
+    vector<int> dirty; //Arcs changed since the flow was last brought up to date
+    vector<bool> a_dirty; //True for every arc listed in dirty
+
+    //CONSTRUCTOR
+    //Description: Reduces the graph formed by the passed Links. The current
+    //capacities are read from the passed adjacency matrix.
+    ReducedGraph(Cap** AM, int nodes, vector<Link> & links, int s, int t)
+    {
+      src = s;
+      dst = t;
+      r_count = 0;
+      r_src = -1;
+      r_dst = -1;
+      RAM = NULL;
+      state = NULL;
+
+      /*-----BUILD SIMPLE GRAPH-----*/
+      vector< vector<int> > adj(nodes); //Neighbors of every node
+      vector< vector<int> > adj_e(nodes); //Edge IDs matching adj
+      vector<int> e_u; //First node of every edge
+      vector<int> e_v; //Other node of every edge
+      for (unsigned int k = 0; k < links.size(); k++)
+      {
+        int u = links[k].getSI();
+        int v = links[k].getEI();
+        if (u != v && findEdge(adj, adj_e, u, v) == -1)
+        {
+          adj[u].push_back(v);
+          adj_e[u].push_back(e_u.size());
+          adj[v].push_back(u);
+          adj_e[v].push_back(e_u.size());
+          e_u.push_back(u);
+          e_v.push_back(v);
+        }
+      }
+      int edges = e_u.size();
+
+      /*-----PENDANT PRUNING-----*/
+      vector<bool> alive(nodes, true);
+      vector<int> deg(nodes, 0);
+      queue<int> Q; //Pendant nodes awaiting removal
+      for (int i = 0; i < nodes; i++)
+      {
+        deg[i] = adj[i].size();
+        if (deg[i] <= 1 && i != s && i != t)
+        {
+          Q.push(i);
+        }
+      }
+      while (!Q.empty())
+      {
+        int u = Q.front();
+        Q.pop();
+        if (!alive[u])
+        {
+          continue;
+        }
+        alive[u] = false;
+        for (unsigned int j = 0; j < adj[u].size(); j++)
+        {
+          int v = adj[u][j];
+          if (alive[v] && --deg[v] <= 1 && v != s && v != t)
+          {
+            Q.push(v);
+          }
+        }
+      }
+
+      /*-----BICONNECTED BLOCKS ON THE S-T PATH-----*/
+      vector<int> block(edges, -1); //Block that each edge belongs to
+      labelBlocks(adj, adj_e, alive, s, block);
+      vector<int> p_edge(nodes, -1); //Edge used to reach each node from s
+      vector<bool> seen(nodes, false);
+      seen[s] = true;
+      Q.push(s);
+      while (!Q.empty())
+      {
+        int u = Q.front();
+        Q.pop();
+        for (unsigned int j = 0; j < adj[u].size(); j++)
+        {
+          int v = adj[u][j];
+          if (alive[v] && !seen[v])
+          {
+            seen[v] = true;
+            p_edge[v] = adj_e[u][j];
+            Q.push(v);
+          }
+        }
+      }
+      l_chain.assign(links.size(), -1);
+      if (s == t || !seen[t]) //No s-t path exists, so the flow is always 0
+      {
+        return;
+      }
+      vector<bool> path_block(edges, false); //Blocks crossed by the s-t path
+      for (int v = t; v != s; v = (e_u[p_edge[v]] == v ?
+                                     e_v[p_edge[v]] : e_u[p_edge[v]]))
+      {
+        path_block[block[p_edge[v]]] = true;
+      }
+      vector<bool> kept(edges, false); //Edges inside the s-t blocks
+      vector<int> k_deg(nodes, 0); //Number of kept edges at each node
+      for (int e = 0; e < edges; e++)
+      {
+        if (block[e] != -1 && path_block[block[e]])
+        {
+          kept[e] = true;
+          k_deg[e_u[e]]++;
+          k_deg[e_v[e]]++;
+        }
+      }
+
+      /*-----SERIES CHAIN CONTRACTION-----*/
+      vector<int> r_id(nodes, -1); //Reduced index of every anchor node
+      for (int i = 0; i < nodes; i++)
+      {
+        if (k_deg[i] > 0 && (k_deg[i] != 2 || i == s || i == t))
+        {
+          r_id[i] = r_count++;
+        }
+      }
+      r_src = r_id[s];
+      r_dst = r_id[t];
+      vector<int> e_chain(edges, -1); //Chain that each edge belongs to
+      vector<int> arc_id(r_count*r_count, -1); //Arc joining two anchors
+      for (int a = 0; a < nodes; a++)
+      {
+        if (r_id[a] == -1)
+        {
+          continue;
+        }
+        for (unsigned int j = 0; j < adj[a].size(); j++)
+        {
+          int e = adj_e[a][j];
+          if (!kept[e] || e_chain[e] != -1)
+          {
+            continue;
+          }
+          /*-----WALK THE CHAIN-----*/
+          int c = c_edge.size();
+          c_edge.push_back(vector<int>());
+          int prev = a;
+          int cur = adj[a][j];
+          e_chain[e] = c;
+          c_edge[c].push_back(prev);
+          c_edge[c].push_back(cur);
+          while (r_id[cur] == -1)
+          {
+            int next_e = -1;
+            int next = -1;
+            for (unsigned int n = 0; n < adj[cur].size(); n++)
+            {
+              if (kept[adj_e[cur][n]] && e_chain[adj_e[cur][n]] == -1)
+              {
+                next_e = adj_e[cur][n];
+                next = adj[cur][n];
+              }
+            }
+            e_chain[next_e] = c;
+            prev = cur;
+            cur = next;
+            c_edge[c].push_back(prev);
+            c_edge[c].push_back(cur);
+          }
+          /*-----ATTACH THE CHAIN TO AN ARC-----*/
+          int x = r_id[a];
+          int y = r_id[cur];
+          int arc = -1;
+          if (x != y) //Loops back to its start can never carry s-t flow
+          {
+            arc = arc_id[x*r_count + y];
+            if (arc == -1)
+            {
+              arc = a_s.size();
+              arc_id[x*r_count + y] = arc;
+              arc_id[y*r_count + x] = arc;
+              a_s.push_back(x);
+              a_e.push_back(y);
+              a_chain.push_back(vector<int>());
+            }
+            a_chain[arc].push_back(c);
+          }
+          c_arc.push_back(arc);
+          c_cap.push_back(0);
+        }
+      }
+      for (unsigned int k = 0; k < links.size(); k++)
+      {
+        int e = findEdge(adj, adj_e, links[k].getSI(), links[k].getEI());
+        if (e != -1 && e_chain[e] != -1 && c_arc[e_chain[e]] != -1)
+        {
+          l_chain[k] = e_chain[e];
+        }
+      }
+
+      /*-----REDUCED ADJACENCY MATRIX CREATION-----*/
+      RAM = new Cap*[r_count];
+      for (int i = 0; i < r_count; i++)
+      {
+        RAM[i] = new Cap[r_count];
+        for (int j = 0; j < r_count; j++)
+        {
+          RAM[i][j] = 0;
+        }
+      }
+      a_dirty.assign(a_s.size(), false);
+      for (unsigned int c = 0; c < c_edge.size(); c++)
+      {
+        if (c_arc[c] != -1)
+        {
+          updateChain(c, AM);
+        }
+      }
+    }
+
+    //COPY CONSTRUCTOR
+    ReducedGraph(ReducedGraph & rhs)
+    {
+      copyFrom(rhs);
+    }
+
+    //CONVERTING CONSTRUCTOR
+    //Description: Copies a reduced graph that stores another capacity type.
+    template <class C2>
+    ReducedGraph(ReducedGraph<C2> & rhs)
+    {
+      copyFrom(rhs);
+    }
+
+    //COPY FROM
+    //Description: Shared body of the copy and converting constructors.
+    template <class C2>
+    void copyFrom(ReducedGraph<C2> & rhs)
+    {
+      src = rhs.src;
+      dst = rhs.dst;
+      r_count = rhs.r_count;
+      r_src = rhs.r_src;
+      r_dst = rhs.r_dst;
+      RAM = NULL;
+      if (rhs.RAM != NULL)
+      {
+        RAM = new Cap*[r_count];
+        for (int i = 0; i < r_count; i++)
+        {
+          RAM[i] = new Cap[r_count];
+          for (int j = 0; j < r_count; j++)
+          {
+            RAM[i][j] = rhs.RAM[i][j];
+          }
+        }
+      }
+      c_edge = rhs.c_edge;
+      c_arc = rhs.c_arc;
+      c_cap = rhs.c_cap;
+      a_chain = rhs.a_chain;
+      a_s = rhs.a_s;
+      a_e = rhs.a_e;
+      l_chain = rhs.l_chain;
+      state = NULL; //The copy calculates its own flow when first needed
+      a_dirty.assign(a_s.size(), false);
+      return;
+    }
+
+    //DESTRUCTOR
+    ~ReducedGraph()
+    {
+      delete state;
+      if (RAM != NULL)
+      {
+        for (int i = 0; i < r_count; i++)
+        {
+          delete []RAM[i];
+        }
+        delete []RAM;
+      }
+    }
+
+    //UPDATE LINK
+    //Description: Called whenever a Link's entry in the original adjacency
+    //matrix changes. Recomputes the capacity of the arc holding that Link.
+    void updateLink(const int index, Cap** AM)
+    {
+      if (l_chain[index] != -1)
+      {
+        updateChain(l_chain[index], AM);
+      }
+      return;
+    }
+
+    //UPDATE CHAIN
+    //Description: A chain carries as much as its weakest edge. The arc's
+    //capacity is the sum of all of its parallel chains.
+    void updateChain(const int c, Cap** AM)
+    {
+      int cap = INT_MAX;
+      for (unsigned int i = 0; i < c_edge[c].size(); i += 2)
+      {
+        cap = min(cap, static_cast<int>(AM[c_edge[c][i]][c_edge[c][i+1]]));
+      }
+      c_cap[c] = cap;
+      int arc = c_arc[c];
+      int total = 0;
+      for (unsigned int i = 0; i < a_chain[arc].size(); i++)
+      {
+        total += c_cap[a_chain[arc][i]];
+      }
+      RAM[a_s[arc]][a_e[arc]] = total;
+      RAM[a_e[arc]][a_s[arc]] = total;
+      if (state != NULL && !a_dirty[arc])
+      {
+        a_dirty[arc] = true;
+        dirty.push_back(arc);
+      }
+      return;
+    }
+
+    //CALCULATE FLOW
+    //Description: Max Flow between src and dst, computed on the reduced graph.
+    //The flow is kept between calls, and only the arcs changed since the last
+    //call are applied to it.
+    int calcFlow()
+    {
+      if (RAM == NULL)
+      {
+        return 0;
+      }
+      if (state == NULL)
+      {
+        state = new FlowState<Cap>(RAM, r_count, r_src, r_dst);
+        return state->value;
+      }
+      if (dirty.empty())
+      {
+        return state->value;
+      }
+      for (unsigned int i = 0; i < dirty.size(); i++)
+      {
+        int arc = dirty[i];
+        state->changeArc(a_s[arc], a_e[arc], RAM[a_s[arc]][a_e[arc]],
+                         RAM[a_e[arc]][a_s[arc]]);
+        a_dirty[arc] = false;
+      }
+      dirty.clear();
+      return state->repairFlow();
+    }
+
+  private:
+    //FIND EDGE
+    //Description: Returns the ID of the edge between u and v, or -1.
+    static int findEdge(vector< vector<int> > & adj,
+                        vector< vector<int> > & adj_e, int u, int v)
+    {
+      for (unsigned int j = 0; j < adj[u].size(); j++)
+      {
+        if (adj[u][j] == v)
+        {
+          return adj_e[u][j];
+        }
+      }
+      return -1;
+    }
+
+    //LABEL BLOCKS
+    //Description: Tarjan's biconnected component algorithm, run iteratively
+    //from the passed root. Every edge reached is labeled with its block.
+    static void labelBlocks(vector< vector<int> > & adj,
+                            vector< vector<int> > & adj_e,
+                            vector<bool> & alive, int root, vector<int> & block)
+    {
+      int nodes = adj.size();
+      vector<int> disc(nodes, -1); //Discovery time of each node
+      vector<int> low(nodes, -1); //Lowest discovery time reachable
+      vector<int> pe(nodes, -1); //Edge used to discover each node
+      vector<int> it(nodes, 0); //Next neighbor to be examined
+      vector<int> e_stack; //Edges of the blocks being built
+      vector<int> n_stack; //DFS stack of nodes
+      int timer = 0;
+      int blocks = 0;
+      disc[root] = low[root] = timer++;
+      n_stack.push_back(root);
+      while (!n_stack.empty())
+      {
+        int u = n_stack.back();
+        if (it[u] < static_cast<int>(adj[u].size()))
+        {
+          int v = adj[u][it[u]];
+          int e = adj_e[u][it[u]];
+          it[u]++;
+          if (!alive[v] || e == pe[u])
+          {
+            continue;
+          }
+          if (disc[v] == -1) //Tree edge
+          {
+            e_stack.push_back(e);
+            pe[v] = e;
+            disc[v] = low[v] = timer++;
+            n_stack.push_back(v);
+          }
+          else if (disc[v] < disc[u]) //Back edge
+          {
+            e_stack.push_back(e);
+            low[u] = min(low[u], disc[v]);
+          }
+        }
+        else
+        {
+          n_stack.pop_back();
+          if (n_stack.empty())
+          {
+            break;
+          }
+          int p = n_stack.back();
+          low[p] = min(low[p], low[u]);
+          if (low[u] >= disc[p]) //p separates u's block from the rest
+          {
+            int e = -1;
+            while (e != pe[u])
+            {
+              e = e_stack.back();
+              e_stack.pop_back();
+              block[e] = blocks;
+            }
+            blocks++;
+          }
+        }
+      }
+      return;
+    }
+};
+
+/////////////
+///NETWORK///
+/////////////
+
+//Cap is the integer type used to store capacities in the adjacency matrix.
+template <class Cap>
+class Network
+{
+  public:
+    int node_count; //Number of Nodes
+    int link_count; //Number of Links
+    int nodes_broken; //Number of broken Nodes
+    int links_broken; //Number of broken Links
+    Cap** AM; //Adjacency Matrix for graphical representation of this Network
+    vector<Node> v_node; //Stores all Nodes in the network
+    vector<Link> v_link; //Stores all Links in the network
+    int RRT; //Remaining Repair Time. Stores remaining amount of time until
+    //a scheduled repair is completed
+    bool LR; //Link Repair. 1 if a single Link is to be repaired
+    bool NR; //Node Repair. 1 is a single Node is to be repaired
+    bool SR; //Smart Repair. 1 if a smart repair is scheduled.
+    int RI; //Repair Index. Stores index of item to be repaired.
+    float b_x; //Barycenter's X-Coordinate
+    float b_y; //Barycenter's Y-Coordinate
+    ReducedGraph<Cap>* reduced; //Reduced graph used for s-t flow, or NULL
+    FailureKernel kernel; //Coordinates and failure masks of every component
+        
+    //CONSTRUCTOR
+    Network()
+    {
+      node_count = 0;
+      link_count = 0;
+      nodes_broken = 0;
+      links_broken = 0;
+      RRT = 0;
+      LR = false;
+      NR = false;
+      SR = false;
+      RI = -1;
+      AM = NULL;
+      reduced = NULL;
+    }
+    
+    //COPY CONSTRUCTOR
+    Network(Network & rhs)
+    {
+      copyFrom(rhs);
+    }
+
+    //CONVERTING CONSTRUCTOR
+    //Description: Copies a Network that stores another capacity type.
+    template <class C2>
+    Network(Network<C2> & rhs)
+    {
+      copyFrom(rhs);
+    }
+
+    //COPY FROM
+    //Description: Shared body of the copy and converting constructors.
+    template <class C2>
+    void copyFrom(Network<C2> & rhs)
+    {
+      node_count = rhs.node_count;
+      link_count = rhs.link_count;
+      nodes_broken = rhs.nodes_broken;
+      links_broken = rhs.links_broken;
+      AM = new Cap*[node_count];
+      for (int i = 0; i < node_count; i++)
+      {
+        AM[i] = new Cap[node_count];
+        for (int j = 0; j < node_count; j++)
+        {
+          AM[i][j] = rhs.AM[i][j];
+        }
+      }
+      for (int i = 0; i < node_count; i++)
+      {
+        v_node.push_back(rhs.v_node[i]);
+      }
+      for (int i = 0; i < link_count; i++)
+      {
+        v_link.push_back(rhs.v_link[i]);
+      }
+      RRT = rhs.RRT;
+      LR = rhs.LR;
+      NR = rhs.NR;
+      SR = rhs.SR;
+      RI = rhs.RI;
+      b_x = rhs.b_x;
+      b_y = rhs.b_y;
+      kernel = rhs.kernel;
+      reduced = NULL;
+      if (rhs.reduced != NULL)
+      {
+        reduced = new ReducedGraph<Cap>(*rhs.reduced);
+      }
+      return;
+    }
+    
+    //DESTRUCTOR
+    ~Network()
+    {
+      for (int i = 0; i < node_count; i++)
+      {
+        delete []AM[i];
+      }
+      delete []AM;
+      delete reduced;
+    }
+    
+    //ACCESSOR FUNCTIONS
+    int getNC(){return node_count;}
+    int getLC(){return link_count;}
+    int getNB(){return nodes_broken;}
+    int getLB(){return links_broken;}
+
+    //ASSESS DAMAGE
+    //Description: Returns the time required to fix the entire network
+    int assessDamage()
+    {
+      int duration = 0; //Stores time required to fix entire network
+      for (int i = 0; i < node_count; i++)
+      {
+        if (v_node[i].broken)
+        {
+          duration += v_node[i].getTIME();
+        }
+      }
+      for (int j = 0; j < link_count; j++)
+      {
+        if (v_link[j].broken)
+        {
+          duration += v_link[j].getTIME();
+        }
+      }
+      return duration;
+    }
+
+    //REDUCE
+    //Description: Builds the reduced graph used for flow between s and t.
+    //Must be called after the Network has been parsed.
+    void reduce(const int s, const int t)
+    {
+      delete reduced;
+      reduced = new ReducedGraph<Cap>(AM, node_count, v_link, s, t);
+      return;
+    }
+
+    //CAPACITY BOUND
+    //Description: Largest value a residual capacity can reach while flow is
+    //calculated. Arcs of the reduced graph add up parallel chains, so this is
+    //bounded by twice the total capacity that can meet at one node.
+    int capacityBound()
+    {
+      vector<int> deg(node_count, 0);
+      int max_deg = 0;
+      for (int k = 0; k < link_count; k++)
+      {
+        max_deg = max(max_deg, ++deg[v_link[k].getSI()]);
+        max_deg = max(max_deg, ++deg[v_link[k].getEI()]);
+      }
+      return 2 * MLC * max_deg;
+    }
+
+    //FLOW
+    //Description: Returns the Max Flow between s and t. The reduced graph is
+    //used when it was built for the same pair of nodes.
+    int flow(const int s, const int t)
+    {
+      if (reduced != NULL && reduced->src == s && reduced->dst == t)
+      {
+        return reduced->calcFlow();
+      }
+      return calcMaxFlow(AM, s, t, node_count);
+    }
+
+    //REPAIR NODE
+    //Description: Schedules a Node to be repaired
+    void repairNode(const int index)
+    {
+      if (RRT != 0 && !v_node[index].broken)
+      {
+        cout << "Error, Illegal use of Repair()" << endl;
+        return;
+      }
+      NR = true;
+      RI = index;
+      RRT = v_node[index].getTIME();
+      return;
+    }
+
+    //REPAIR LINK
+    //Description: Schedules a Link to be repaired
+    void repairLink(const int index)
+    {
+      if (RRT != 0 || !v_link[index].broken)
+      {
+        cout << "Error, Illegal use of Repair()" << endl;
+        return;
+      }
+      LR = true;
+      RI = index;
+      RRT = v_link[index].getTIME();
+      return;
+    }
+
+    //SMART REPAIR TIME CALCULATOR
+    //Description: Evaluates the required time to repair a Link and its two
+    //related Nodes.
+    int calcSRT(const int index)
+    {
+      int SRT = 0;
+      if (v_link[index].broken)
+      {
+        SRT += v_link[index].getTIME();
+      }
+      if (v_node[v_link[index].getSI()].broken) //Link's first node is broken
+      {
+        SRT += v_node[v_link[index].getSI()].getTIME(); //Add more repair time
+      }   
+      if (v_node[v_link[index].getEI()].broken) //If other node is broken
+      {
+        SRT += v_node[v_link[index].getEI()].getTIME();
+      } 
+      return SRT;
+    }
+
+    //SMART REPAIR
+    //Description: Schedules a Link to be repaired, and if either of the nodes
+    //attached to that Link are broken, they are scheduled to be repaired too.
+    void smartRepair(const int index)
+    {
+      if (RRT != 0 || v_link[index].connected)
+      {
+        cout << "Error, Illegal use of Repair()" << endl;
+        return;
+      }
+      SR = true;
+      RI = index;
+      RRT = calcSRT(index);
+      return;
+    }
+    
+    //PROGRESS
+    //Description: This function decreases the remaining time on any scheduled
+    //repair. If RRT reaches zero, then the repair is completed, and the
+    //repaired objects are marked as functional.
+    void progress()
+    {
+      if (RRT > 0) //Repair is still being processed
+      {
+        cout << "Repair not yet completed." << endl;
+      }
+      else if (NR) //Node Repair was completed
+      {
+        NR = false;
+        v_node[RI].broken = false;
+        nodes_broken--;
+        RI = -1;
+        connect();
+      }
+      else if (LR) //Link Repair was completed
+      {
+        LR = false;
+        v_link[RI].broken = false;
+        links_broken--;
+        RI = -1;
+        connect();
+      }
+      else if (SR) //Smart Repair was completed
+      {
+        SR = false;
+        int temp_s = v_link[RI].getSI();
+        int temp_e = v_link[RI].getEI();
+        if (v_node[temp_s].broken == true)
+        {
+          v_node[temp_s].broken = false;
+          nodes_broken--;
+        }
+        if (v_node[temp_e].broken == true)
+        {
+          v_node[temp_e].broken = false;
+          nodes_broken--;
+        }
+        if (v_link[RI].broken == true)
+        {
+          v_link[RI].broken = false;
+          links_broken--;
+        }
+        RI = -1;
+        connect();
+      }
+      else
+      {
+        cout << "Error. No repair was scheduled to be completed." << endl;
+      }
+      return;
+    }
+    
+    //CONNECT
+    //Description: This function updates all unconnected Links.
+    void connect()
+    {
+      for (int k = 0; k < link_count; k++)
+      {
+        if (v_link[k].connected == false) //Link is marked as unconnected
+        {
+          if (!v_node[v_link[k].getSI()].broken &&
+              !v_node[v_link[k].getEI()].broken &&
+              !v_link[k].broken)
+          //If both nodes are functional and the link is repaired
+          {
             v_link[k].connected = true;
             AM[v_link[k].getSI()][v_link[k].getEI()] = v_link[k].getCAP();
             AM[v_link[k].getEI()][v_link[k].getSI()] = v_link[k].getCAP();
+            if (reduced != NULL)
+            {
+              reduced->updateLink(k, AM);
+            }
+          }
+        }
+        else //Link is marked as connected
+        {
+          if (v_node[v_link[k].getSI()].broken ||
+              v_node[v_link[k].getEI()].broken ||
+              v_link[k].broken)
+          //If either nodes is broken or the link itself is broken
+          {
+            v_link[k].connected = false;
+            AM[v_link[k].getSI()][v_link[k].getEI()] = 0;
+            AM[v_link[k].getEI()][v_link[k].getSI()] = 0;
+            if (reduced != NULL)
+            {
+              reduced->updateLink(k, AM);
+            }
+          }
+        }
+      }
+      return;
+    }
+
+    //RANDOM FAILING FUNCTION
+    //Description: Based on the % passed, breaks sensors and links. A single
+    //call to rand() seeds the failure kernel.
+    void randomFail(const int percent)
+    {
+      kernel.randomMask(rand(), percent);
+      applyFailure();
+      return;
+    }
+
+    //GEOGRAPHIC FAILING FUNCTION
+    //Description: Based on a circular region that contains all nodes, breaks
+    //nodes within the passed % of the the regions's radius.
+    void geoFail(const float percent)
+    {
+      kernel.geoMask(b_x, b_y, percent);
+      applyFailure();
+      return;
+    }
+
+    //APPLY FAILURE
+    //Description: Breaks every component whose bit is set in the kernel's
+    //masks. Only set bits are visited, so the cost follows the size of the
+    //failure rather than the size of the Network.
+    void applyFailure()
+    {
+      for (size_t w = 0; w < kernel.n_mask.size(); w++)
+      {
+        for (uint64_t bits = kernel.n_mask[w]; bits != 0; bits &= bits - 1)
+        {
+          int i = w*64 + __builtin_ctzll(bits);
+          if (!v_node[i].broken)
+          {
+            v_node[i].broken = true;
+            nodes_broken++;
+          }
+        }
+      }
+      for (size_t w = 0; w < kernel.l_mask.size(); w++)
+      {
+        for (uint64_t bits = kernel.l_mask[w]; bits != 0; bits &= bits - 1)
+        {
+          int i = w*64 + __builtin_ctzll(bits);
+          if (!v_link[i].broken)
+          {
+            v_link[i].broken = true;
+            links_broken++;
+          }
+        }
+      }
+      connect();
+      return;
+    }
+
+    //SET NODE
+    //Description: Marks a Node as broken or working without updating the
+    //Links, so a batch of changes needs only one call to connect(). Returns
+    //false if the Node was already in that state.
+    bool setNode(const int index, const bool broken)
+    {
+      if (v_node[index].broken == broken)
+      {
+        return false;
+      }
+      v_node[index].broken = broken;
+      nodes_broken += (broken ? 1 : -1);
+      return true;
+    }
+
+    //SET LINK
+    //Description: Marks a Link as broken or working, in the same way as
+    //setNode().
+    bool setLink(const int index, const bool broken)
+    {
+      if (v_link[index].broken == broken)
+      {
+        return false;
+      }
+      v_link[index].broken = broken;
+      links_broken += (broken ? 1 : -1);
+      return true;
+    }
+
+    //FAIL NODE
+    //Description: Breaks a single Node while repairs are under way. If the
+    //Node belongs to a scheduled smart repair that did not plan on fixing it,
+    //its repair time is added to the remaining repair time.
+    void failNode(const int index)
+    {
+      if (v_node[index].broken)
+      {
+        return;
+      }
+      if (SR && (v_link[RI].getSI() == index || v_link[RI].getEI() == index))
+      {
+        RRT += v_node[index].getTIME();
+      }
+      v_node[index].broken = true;
+      nodes_broken++;
+      connect();
+      return;
+    }
+
+    //FAIL LINK
+    //Description: Breaks a single Link while repairs are under way, in the
+    //same way as failNode().
+    void failLink(const int index)
+    {
+      if (v_link[index].broken)
+      {
+        return;
+      }
+      if (SR && RI == index)
+      {
+        RRT += v_link[index].getTIME();
+      }
+      v_link[index].broken = true;
+      links_broken++;
+      connect();
+      return;
+    }
+
+};
+
+//////////////////////
+///FAILURE SCHEDULE///
+//////////////////////
+
+//Description: Failures that arrive while the network is being repaired. They
+//are planned before any policy runs, so every policy faces the same events.
+//Each aftershock breaks components at random, with 1/AFTERSHOCK_SHARE of the
+//first failure's percent, drawn as masks from the Network's FailureKernel.
+//Each aftershock may then set off a cascade of overloads. The s-t flow is
+//routed again around the broken components, and every Link that the new
+//flow fills to capacity, but that was not full before, trips with a chance
+//of OVERLOAD_PCT percent. The flow is routed again around the tripped Links,
+//and so on until no Link trips. The loads are those of the network without
+//any repairs, since repairs differ between policies but the events may not.
+class FailureSchedule
+{
+  public:
+    vector<int> e_time; //Time of each failure, in increasing order
+    vector<bool> e_node; //True if the failure breaks a Node, false for a Link
+    vector<int> e_index; //Index of the broken Node or Link
+
+    //PLAN
+    //Description: Plans shocks aftershocks at random times before horizon,
+    //each followed by the overloads it causes.
+    template <class Cap>
+    void plan(Network<Cap> & comm_net, const int shocks, const int percent,
+              const int horizon)
+    {
+      e_time.clear();
+      e_node.clear();
+      e_index.clear();
+      if (shocks <= 0)
+      {
+        return;
+      }
+      vector<int> when; //Time of each aftershock
+      vector<int> seed; //Seed of each aftershock's failure masks
+      vector<int> order; //Aftershocks in the order they happen
+      for (int a = 0; a < shocks; a++)
+      {
+        when.push_back((rand()%max(1, horizon)) + 1);
+        seed.push_back(rand());
+        order.push_back(a);
+      }
+      stable_sort(order.begin(), order.end(), EarlierEvent(when));
+      int share = max(1, percent / AFTERSHOCK_SHARE);
+      vector< vector<int> > n_link(comm_net.getNC()); //Links of each Node
+      vector<bool> down(comm_net.getLC()); //Links carrying no flow
+      for (int k = 0; k < comm_net.getLC(); k++)
+      {
+        n_link[comm_net.v_link[k].getSI()].push_back(k);
+        n_link[comm_net.v_link[k].getEI()].push_back(k);
+        down[k] = !comm_net.v_link[k].connected;
+      }
+      FlowState<Cap> load(comm_net.AM, comm_net.getNC(), SRCID, DSTID);
+      vector<bool> full = saturated(comm_net, load, down); //Links at capacity
+      FailureKernel & kernel = comm_net.kernel;
+      for (unsigned int a = 0; a < order.size(); a++)
+      {
+        int t = when[order[a]];
+        kernel.randomMask(seed[order[a]], share);
+        for (unsigned int w = 0; w < kernel.n_mask.size(); w++)
+        {
+          for (uint64_t bits = kernel.n_mask[w]; bits != 0; bits &= bits - 1)
+          {
+            int i = w*64 + __builtin_ctzll(bits);
+            addEvent(t, true, i);
+            for (unsigned int j = 0; j < n_link[i].size(); j++)
+            {
+              cut(comm_net, load, down, n_link[i][j]);
+            }
+          }
+        }
+        for (unsigned int w = 0; w < kernel.l_mask.size(); w++)
+        {
+          for (uint64_t bits = kernel.l_mask[w]; bits != 0; bits &= bits - 1)
+          {
+            int k = w*64 + __builtin_ctzll(bits);
+            addEvent(t, false, k);
+            cut(comm_net, load, down, k);
+          }
+        }
+
+        /*-----OVERLOAD CASCADE-----*/
+        bool tripped = true; //True while the last round tripped a Link
+        while (tripped)
+        {
+          load.repairFlow();
+          vector<bool> now = saturated(comm_net, load, down);
+          tripped = false;
+          for (int k = 0; k < comm_net.getLC(); k++)
+          {
+            if (now[k] && !full[k] && rand()%100 < OVERLOAD_PCT)
+            {
+              addEvent(t, false, k);
+              cut(comm_net, load, down, k);
+              tripped = true;
+            }
+          }
+          full = now;
+        }
+      }
+      return;
+    }
+
+    //APPLY
+    //Description: Applies every failure due by the passed time, starting at
+    //event next. Returns the index of the first event still to come.
+    template <class Cap>
+    int apply(Network<Cap> & comm_net, const int clock, int next)
+    {
+      for (; next < static_cast<int>(e_time.size()) && e_time[next] <= clock;
+           next++)
+      {
+        if (e_node[next])
+        {
+          comm_net.failNode(e_index[next]);
+        }
+        else
+        {
+          comm_net.failLink(e_index[next]);
+        }
+      }
+      return next;
+    }
+
+  private:
+    //ADD EVENT
+    //Description: Appends a failure to the schedule.
+    void addEvent(const int t, const bool node, const int index)
+    {
+      e_time.push_back(t);
+      e_node.push_back(node);
+      e_index.push_back(index);
+      return;
+    }
+
+    //CUT
+    //Description: Removes Link k from the planned loads. repairFlow() must be
+    //called before the loads are used again.
+    template <class Cap>
+    static void cut(Network<Cap> & comm_net, FlowState<Cap> & load,
+                    vector<bool> & down, const int k)
+    {
+      if (!down[k])
+      {
+        down[k] = true;
+        load.changeArc(comm_net.v_link[k].getSI(),
+                       comm_net.v_link[k].getEI(), 0, 0);
+      }
+      return;
+    }
+
+    //SATURATED
+    //Description: Returns which Links carry as much flow as they can hold.
+    template <class Cap>
+    static vector<bool> saturated(Network<Cap> & comm_net,
+                                  FlowState<Cap> & load, vector<bool> & down)
+    {
+      vector<bool> full(comm_net.getLC(), false);
+      for (int k = 0; k < comm_net.getLC(); k++)
+      {
+        int i = comm_net.v_link[k].getSI();
+        int j = comm_net.v_link[k].getEI();
+        int c = load.CG[i][j];
+        full[k] = !down[k] && c > 0 && abs(c - load.RG[i][j]) >= c;
+      }
+      return full;
+    }
+
+    //Description: Orders planned events by their time.
+    struct EarlierEvent
+    {
+      vector<int> & when;
+      EarlierEvent(vector<int> & w) : when(w) {}
+      bool operator()(int a, int b) const {return when[a] < when[b];}
+    };
+};
+
+////////////////////
+///SWEEP SETTINGS///
+////////////////////
+
+//Description: Parameters of a failure sweep. Every failure percent from
+//p_from to p_to (in steps of p_step) is tried in the given number of trials.
+//Each trial may also plan aftershocks that arrive during its repairs.
+//If target is above 0, the sweep is adaptive: trials are run in batches,
+//and a percent stops once the 95% confidence interval of the difference
+//between the Greedy and Random average flows is narrower than target. The
+//number of trials then only acts as a limit.
+struct SweepSettings
+{
+  int mode; //Failure mode, 0 geographical or 1 random
+  int p_from; //First failure percent
+  int p_to; //Last failure percent
+  int p_step; //Step between failure percents
+  int trials; //Trials per failure percent
+  double target; //Confidence interval width to reach, 0 if not adaptive
+  int shocks; //Aftershocks during each trial's repairs
+  uint32_t seed; //Seed that all trial seeds are derived from
+  string file; //Name of the result file
+
+  //CONSTRUCTOR
+  SweepSettings()
+  {
+    mode = 1;
+    p_from = 0;
+    p_to = 0;
+    p_step = 1;
+    trials = 1;
+    target = 0;
+    shocks = 0;
+    seed = 0;
+  }
+
+  //ACCESSOR FUNCTIONS
+  int getPC(){return (p_to - p_from) / p_step + 1;} //Number of percents
+  uint64_t getTC(){return static_cast<uint64_t>(getPC()) * trials;}
+  int getBatch(){return (target > 0 ? ADAPT_BATCH : trials);}
+};
+
+//////////////////
+///SWEEP TOTALS///
+//////////////////
+
+//Description: Running totals of the average flow of every trial, kept for
+//every (percent, policy) cell of a sweep. Cell (p, pol) of the sweep's p-th
+//percent is stored at index p*POLICIES + pol. The difference between the
+//Greedy and Random average flows of the same trial is also totaled for every
+//percent.
+struct SweepTotals
+{
+  vector<double> sum; //Sum of the trials' average flows
+  vector<double> sq; //Sum of the trials' squared average flows
+  vector<uint64_t> count; //Number of trials
+  vector<double> d_sum; //Sum of the Greedy-Random differences
+  vector<double> d_sq; //Sum of the squared Greedy-Random differences
+
+  //RESET
+  void reset(const int percents)
+  {
+    sum.assign(percents*POLICIES, 0);
+    sq.assign(percents*POLICIES, 0);
+    count.assign(percents*POLICIES, 0);
+    d_sum.assign(percents, 0);
+    d_sq.assign(percents, 0);
+    return;
+  }
+
+  //ADD DIFFERENCE
+  void addDiff(const int percent, const double diff)
+  {
+    d_sum[percent] += diff;
+    d_sq[percent] += diff * diff;
+    return;
+  }
+
+  //TRIALS
+  //Description: Number of trials run for the sweep's p-th percent.
+  uint64_t trials(const int percent)
+  {
+    return count[percent*POLICIES];
+  }
+
+  //INTERVAL WIDTH
+  //Description: Width of the 95% confidence interval of the mean
+  //Greedy-Random difference for the sweep's p-th percent. The variance is
+  //estimated from the trials, so Student's t is used instead of the normal
+  //quantile; at ADAPT_MIN trials the normal one is about 8% too narrow.
+  double width(const int percent)
+  {
+    double n = trials(percent);
+    if (n < 2)
+    {
+      return INFINITY;
+    }
+    double mean = d_sum[percent] / n;
+    double var = max(0.0, (d_sq[percent] - n*mean*mean) / (n - 1));
+    return 2 * quantile(n - 1) * sqrt(var / n);
+  }
+
+  //QUANTILE
+  //Description: Two-sided 95% quantile of Student's t with df degrees of
+  //freedom. Exact values are tabled up to 30; past that, the Cornish-Fisher
+  //expansion around CI_Z is accurate to better than 0.001.
+  static double quantile(const double df)
+  {
+    static const double T_975[30] = {
+      12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+      2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+      2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if (df <= 30)
+    {
+      return T_975[static_cast<int>(df) - 1];
+    }
+    double z = CI_Z;
+    return z + (z*z*z + z) / (4*df) +
+           (5*pow(z, 5) + 16*z*z*z + 3*z) / (96*df*df);
+  }
+
+  //ADD
+  void add(const int cell, const double avg)
+  {
+    sum[cell] += avg;
+    sq[cell] += avg * avg;
+    count[cell]++;
+    return;
+  }
+
+  //MEAN
+  double mean(const int cell)
+  {
+    return (count[cell] == 0 ? 0 : sum[cell] / count[cell]);
+  }
+};
+
+////////////////
+///RING QUEUE///
+////////////////
+
+//Description: Bounded queue shared by any number of producer and consumer
+//threads, without locks. Every slot keeps a sequence number that tells
+//whether it is free for the push or ready for the pop of the current lap,
+//and threads claim positions by moving the head or tail with a
+//compare-and-swap. push() waits while the queue is full and pop() waits
+//while it is empty. Waiting threads use backoff().
+template <class T>
+class RingQueue
+{
+  public:
+    //CONSTRUCTOR
+    RingQueue(const int capacity)
+    {
+      cap = capacity;
+      slot = new Slot[cap];
+      for (uint64_t i = 0; i < cap; i++)
+      {
+        slot[i].seq.store(i);
+      }
+      head.store(0);
+      tail.store(0);
+    }
+
+    //DESTRUCTOR
+    ~RingQueue()
+    {
+      delete []slot;
+    }
+
+    //PUSH
+    void push(const T & item)
+    {
+      uint64_t t = tail.load(memory_order_relaxed);
+      for (int n = 0; ; )
+      {
+        Slot & s = slot[t % cap];
+        int64_t diff = static_cast<int64_t>(s.seq.load(memory_order_acquire)
+                                            - t);
+        if (diff == 0 && tail.compare_exchange_weak(t, t + 1,
+                                                    memory_order_relaxed))
+        {
+          s.item = item;
+          s.seq.store(t + 1, memory_order_release);
+          return;
+        }
+        if (diff < 0) //Full
+        {
+          backoff(n++);
+          t = tail.load(memory_order_relaxed);
+        }
+        else if (diff > 0) //Another producer took the slot
+        {
+          t = tail.load(memory_order_relaxed);
+        }
+      }
+    }
+
+    //POP
+    T pop()
+    {
+      uint64_t h = head.load(memory_order_relaxed);
+      for (int n = 0; ; )
+      {
+        Slot & s = slot[h % cap];
+        int64_t diff = static_cast<int64_t>(s.seq.load(memory_order_acquire)
+                                            - (h + 1));
+        if (diff == 0 && head.compare_exchange_weak(h, h + 1,
+                                                    memory_order_relaxed))
+        {
+          T item = s.item;
+          s.seq.store(h + cap, memory_order_release);
+          return item;
+        }
+        if (diff < 0) //Empty
+        {
+          backoff(n++);
+          h = head.load(memory_order_relaxed);
+        }
+        else if (diff > 0) //Another consumer took the slot
+        {
+          h = head.load(memory_order_relaxed);
+        }
+      }
+    }
+
+  private:
+    //Description: One stored item and the position it belongs to.
+    struct Slot
+    {
+      atomic<uint64_t> seq; //Position + 1 when full, next lap's position
+      //when free
+      T item; //Stored item
+    };
+
+    uint64_t cap; //Number of slots
+    Slot* slot; //Stored items
+    alignas(64) atomic<uint64_t> head; //Next position to pop
+    alignas(64) atomic<uint64_t> tail; //Next position to push
+};
+
+//////////////////
+///RESULT STORE///
+//////////////////
+
+//Description: Sweep results are stored in a binary, column-oriented file so
+//that millions of flow samples can be written and read back quickly:
+// - A fixed ResultHeader at the start of the file holds summary statistics
+//   for every row in the file. It is rewritten after every block.
+// - Blocks of up to BLOCK_ROWS rows follow. Each block is a ResultBlock
+//   followed by one array per column. Every column starts on an 8-byte
+//   boundary, so a memory-mapped file can be read in place.
+// - Blocks are only ever appended. A block that was not fully written (for
+//   example, after a crash) is not counted in the header and is dropped the
+//   next time the file is opened for writing.
+const char RESULT_MAGIC[8] = {'S','N','R','R','E','S','1','\0'};
+const uint32_t BLOCK_MAGIC = 0x4B4C4253; //"SBLK"
+const int BLOCK_ROWS = 65536; //Rows buffered before a block is written
+const int MAX_POLICIES = 8; //Policies tracked in the file summary
+
+struct ResultHeader
+{
+  char magic[8]; //RESULT_MAGIC
+  uint64_t blocks; //Number of complete blocks
+  uint64_t rows; //Number of rows in all blocks
+  uint64_t bytes; //Size of the header and all complete blocks
+  int64_t flow_sum; //Sum of all flows
+  double flow_sq; //Sum of all squared flows
+  int32_t flow_min; //Smallest flow
+  int32_t flow_max; //Largest flow
+  int32_t time_max; //Latest sample time
+  int32_t unused; //Keeps the following arrays 8-byte aligned
+  uint64_t p_rows[MAX_POLICIES]; //Rows written for each policy
+  int64_t p_flow[MAX_POLICIES]; //Sum of flows for each policy
+};
+
+struct ResultBlock
+{
+  uint32_t magic; //BLOCK_MAGIC
+  uint32_t rows; //Number of rows in this block
+};
+
+//Description: Byte offsets of each column from the end of a ResultBlock with
+//the passed number of rows. Columns are ordered by element size so that every
+//column stays aligned to its own size.
+struct ResultColumns
+{
+  uint64_t trial; //uint64_t: trial ID
+  uint64_t seed; //uint32_t: seed used for the trial
+  uint64_t time; //int32_t: time of the sample
+  uint64_t flow; //int32_t: flow at that time
+  uint64_t mode; //uint8_t: failure mode, 0 geographical or 1 random
+  uint64_t percent; //uint8_t: failure percent
+  uint64_t policy; //uint8_t: repair policy
+  uint64_t size; //Total size of the columns, padded to 8 bytes
+
+  ResultColumns(uint64_t rows)
+  {
+    trial = 0;
+    seed = trial + 8*rows;
+    time = seed + 4*rows;
+    flow = time + 4*rows;
+    mode = flow + 4*rows;
+    percent = mode + rows;
+    policy = percent + rows;
+    size = ((policy + rows) + 7) / 8 * 8;
+  }
+};
+
+///////////////////
+///RESULT WRITER///
+///////////////////
+
+//Description: Buffers rows column by column and appends them to a result
+//file one block at a time.
+class ResultWriter
+{
+  public:
+    //CONSTRUCTOR
+    //Description: Opens the named file. New rows are appended to the rows
+    //already in the file. A file shorter than its header says is refused,
+    //since its rows can not be trusted.
+    ResultWriter(const string name)
+    {
+      filename = name;
+      good = false;
+      memset(&header, 0, sizeof(header));
+      bool valid = false;
+      ifstream fin(name.c_str(), ios::binary);
+      if (fin.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+          memcmp(header.magic, RESULT_MAGIC, 8) == 0)
+      {
+        valid = true;
+      }
+      fin.close();
+      if (!valid) //New file
+      {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, RESULT_MAGIC, 8);
+        header.flow_min = INT_MAX;
+        header.flow_max = INT_MIN;
+        header.bytes = sizeof(header);
+        ofstream fnew(name.c_str(), ios::binary | ios::trunc);
+        fnew.write(reinterpret_cast<char*>(&header), sizeof(header));
+        fnew.close();
+        if (!fnew)
+        {
+          return;
+        }
+      }
+      else //Drops an incomplete block at the end of the file
+      {
+        struct stat info;
+        if (stat(name.c_str(), &info) != 0 ||
+            static_cast<uint64_t>(info.st_size) < header.bytes ||
+            truncate(name.c_str(), header.bytes) != 0)
+        {
+          return;
+        }
+      }
+      fout.open(name.c_str(), ios::binary | ios::in | ios::out);
+      fout.seekp(header.bytes);
+      good = static_cast<bool>(fout);
+    }
+
+    //DESTRUCTOR
+    ~ResultWriter()
+    {
+      flush();
+      fout.close();
+    }
+
+    //ACCESSOR FUNCTIONS
+    uint64_t getRows(){return header.rows + c_trial.size();}
+    bool isGood(){return good;} //False once the file could not be written
+
+    //APPEND
+    //Description: Adds one row. The row is written once its block fills up
+    //or flush() is called.
+    void append(uint64_t trial, uint32_t seed, uint8_t mode, uint8_t percent,
+                uint8_t policy, int32_t time, int32_t flow)
+    {
+      c_trial.push_back(trial);
+      c_seed.push_back(seed);
+      c_time.push_back(time);
+      c_flow.push_back(flow);
+      c_mode.push_back(mode);
+      c_percent.push_back(percent);
+      c_policy.push_back(policy);
+      if (static_cast<int>(c_trial.size()) >= BLOCK_ROWS)
+      {
+        flush();
+      }
+      return;
+    }
+
+    //FLUSH
+    //Description: Writes all buffered rows as one block, then rewrites the
+    //header so that it covers the new block.
+    void flush()
+    {
+      uint32_t rows = c_trial.size();
+      if (rows == 0 || !good)
+      {
+        return;
+      }
+      ResultBlock block;
+      block.magic = BLOCK_MAGIC;
+      block.rows = rows;
+      ResultColumns col(rows);
+      vector<char> data(col.size, 0); //Block's columns, laid out in memory
+      memcpy(&data[col.trial], &c_trial[0], rows*sizeof(uint64_t));
+      memcpy(&data[col.seed], &c_seed[0], rows*sizeof(uint32_t));
+      memcpy(&data[col.time], &c_time[0], rows*sizeof(int32_t));
+      memcpy(&data[col.flow], &c_flow[0], rows*sizeof(int32_t));
+      memcpy(&data[col.mode], &c_mode[0], rows);
+      memcpy(&data[col.percent], &c_percent[0], rows);
+      memcpy(&data[col.policy], &c_policy[0], rows);
+      fout.write(reinterpret_cast<char*>(&block), sizeof(block));
+      fout.write(&data[0], col.size);
+      fout.flush();
+      if (!fout)
+      {
+        good = false;
+        return;
+      }
+
+      /*-----SUMMARY STATISTICS-----*/
+      for (uint32_t i = 0; i < rows; i++)
+      {
+        header.flow_sum += c_flow[i];
+        header.flow_sq += static_cast<double>(c_flow[i]) * c_flow[i];
+        header.flow_min = min(header.flow_min, c_flow[i]);
+        header.flow_max = max(header.flow_max, c_flow[i]);
+        header.time_max = max(header.time_max, c_time[i]);
+        if (c_policy[i] < MAX_POLICIES)
+        {
+          header.p_rows[c_policy[i]]++;
+          header.p_flow[c_policy[i]] += c_flow[i];
+        }
+      }
+      header.blocks++;
+      header.rows += rows;
+      header.bytes += sizeof(block) + col.size;
+      fout.seekp(0);
+      fout.write(reinterpret_cast<char*>(&header), sizeof(header));
+      fout.seekp(header.bytes);
+      fout.flush();
+      good = static_cast<bool>(fout);
+
+      c_trial.clear();
+      c_seed.clear();
+      c_time.clear();
+      c_flow.clear();
+      c_mode.clear();
+      c_percent.clear();
+      c_policy.clear();
+      return;
+    }
+
+    //SAVE STATE
+    //Description: Writes the file header and all buffered rows, so that the
+    //writer can later be brought back to exactly this point.
+    void saveState(ostream & os)
+    {
+      fout.flush();
+      os.write(reinterpret_cast<char*>(&header), sizeof(header));
+      writeColumn(os, c_trial);
+      writeColumn(os, c_seed);
+      writeColumn(os, c_time);
+      writeColumn(os, c_flow);
+      writeColumn(os, c_mode);
+      writeColumn(os, c_percent);
+      writeColumn(os, c_policy);
+      return;
+    }
+
+    //LOAD STATE
+    //Description: Brings the writer back to a point saved by saveState().
+    //Blocks written to the file after that point are dropped. Returns false
+    //if the state could not be read or the file is shorter than expected.
+    bool loadState(istream & is)
+    {
+      ResultHeader saved;
+      if (!is.read(reinterpret_cast<char*>(&saved), sizeof(saved)) ||
+          memcmp(saved.magic, RESULT_MAGIC, 8) != 0 ||
+          saved.bytes > header.bytes)
+      {
+        return false;
+      }
+      if (!readColumn(is, c_trial) || !readColumn(is, c_seed) ||
+          !readColumn(is, c_time) || !readColumn(is, c_flow) ||
+          !readColumn(is, c_mode) || !readColumn(is, c_percent) ||
+          !readColumn(is, c_policy))
+      {
+        return false;
+      }
+      header = saved;
+      fout.close();
+      if (truncate(filename.c_str(), header.bytes) != 0)
+      {
+        good = false;
+        return false;
+      }
+      fout.open(filename.c_str(), ios::binary | ios::in | ios::out);
+      fout.seekp(0);
+      fout.write(reinterpret_cast<char*>(&header), sizeof(header));
+      fout.seekp(header.bytes);
+      fout.flush();
+      good = static_cast<bool>(fout);
+      return good;
+    }
+
+  private:
+    string filename; //Name of the result file
+    fstream fout; //Open result file
+    bool good; //True while every write to the file has succeeded
+    ResultHeader header; //Summary of all complete blocks
+    vector<uint64_t> c_trial; //Buffered trial ID column
+    vector<uint32_t> c_seed; //Buffered seed column
+    vector<int32_t> c_time; //Buffered time column
+    vector<int32_t> c_flow; //Buffered flow column
+    vector<uint8_t> c_mode; //Buffered failure mode column
+    vector<uint8_t> c_percent; //Buffered failure percent column
+    vector<uint8_t> c_policy; //Buffered policy column
+
+    //WRITE COLUMN
+    //Description: Writes a buffered column's length followed by its values.
+    template <class T>
+    static void writeColumn(ostream & os, vector<T> & col)
+    {
+      uint64_t n = col.size();
+      os.write(reinterpret_cast<char*>(&n), sizeof(n));
+      if (n > 0)
+      {
+        os.write(reinterpret_cast<char*>(&col[0]), n*sizeof(T));
+      }
+      return;
+    }
+
+    //READ COLUMN
+    //Description: Reads a column written by writeColumn().
+    template <class T>
+    static bool readColumn(istream & is, vector<T> & col)
+    {
+      uint64_t n = 0;
+      if (!is.read(reinterpret_cast<char*>(&n), sizeof(n)) || n > BLOCK_ROWS)
+      {
+        return false;
+      }
+      col.resize(n);
+      return n == 0 ||
+             is.read(reinterpret_cast<char*>(&col[0]), n*sizeof(T));
+    }
+};
+
+///////////////////
+///RESULT READER///
+///////////////////
+
+//Description: Memory-maps a result file. Columns are read in place, so an
+//aggregate only touches the columns it needs.
+class ResultReader
+{
+  public:
+    ResultHeader* header; //File summary, NULL if the file could not be read
+    vector<const char*> b_data; //Start of each block's columns
+    vector<uint32_t> b_rows; //Number of rows in each block
+
+    //CONSTRUCTOR
+    ResultReader(const string name)
+    {
+      header = NULL;
+      base = NULL;
+      length = 0;
+      int fd = open(name.c_str(), O_RDONLY);
+      if (fd < 0)
+      {
+        return;
+      }
+      struct stat info;
+      if (fstat(fd, &info) == 0 &&
+          info.st_size >= static_cast<off_t>(sizeof(ResultHeader)))
+      {
+        length = info.st_size;
+        void* map = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED)
+        {
+          base = static_cast<const char*>(map);
+        }
+      }
+      close(fd);
+      if (base == NULL)
+      {
+        return;
+      }
+      header = reinterpret_cast<ResultHeader*>(const_cast<char*>(base));
+      if (memcmp(header->magic, RESULT_MAGIC, 8) != 0 ||
+          header->bytes > length)
+      {
+        header = NULL;
+        return;
+      }
+      /*-----LOCATE BLOCKS-----*/
+      //A block that does not fit in the header's size means the file is
+      //damaged, and the whole file is rejected.
+      uint64_t offset = sizeof(ResultHeader);
+      for (uint64_t b = 0; b < header->blocks; b++)
+      {
+        const ResultBlock* block =
+          reinterpret_cast<const ResultBlock*>(base + offset);
+        if (offset + sizeof(ResultBlock) > header->bytes ||
+            block->magic != BLOCK_MAGIC ||
+            ResultColumns(block->rows).size >
+              header->bytes - offset - sizeof(ResultBlock))
+        {
+          header = NULL;
+          b_data.clear();
+          b_rows.clear();
+          return;
+        }
+        b_data.push_back(base + offset + sizeof(ResultBlock));
+        b_rows.push_back(block->rows);
+        offset += sizeof(ResultBlock) + ResultColumns(block->rows).size;
+      }
+    }
+
+    //DESTRUCTOR
+    ~ResultReader()
+    {
+      if (base != NULL)
+      {
+        munmap(const_cast<char*>(base), length);
+      }
+    }
+
+    //COLUMN ACCESSORS
+    //Description: Return the named column of block b.
+    const uint64_t* trial(int b)
+    {
+      return reinterpret_cast<const uint64_t*>(b_data[b] +
+                                               ResultColumns(b_rows[b]).trial);
+    }
+    const uint32_t* seed(int b)
+    {
+      return reinterpret_cast<const uint32_t*>(b_data[b] +
+                                               ResultColumns(b_rows[b]).seed);
+    }
+    const int32_t* time(int b)
+    {
+      return reinterpret_cast<const int32_t*>(b_data[b] +
+                                              ResultColumns(b_rows[b]).time);
+    }
+    const int32_t* flow(int b)
+    {
+      return reinterpret_cast<const int32_t*>(b_data[b] +
+                                              ResultColumns(b_rows[b]).flow);
+    }
+    const uint8_t* mode(int b)
+    {
+      return reinterpret_cast<const uint8_t*>(b_data[b] +
+                                              ResultColumns(b_rows[b]).mode);
+    }
+    const uint8_t* percent(int b)
+    {
+      return reinterpret_cast<const uint8_t*>(b_data[b] +
+                                              ResultColumns(b_rows[b]).percent);
+    }
+    const uint8_t* policy(int b)
+    {
+      return reinterpret_cast<const uint8_t*>(b_data[b] +
+                                              ResultColumns(b_rows[b]).policy);
+    }
+
+    //CELL TOTALS
+    //Description: Sums the flow and counts the rows of every (mode, percent,
+    //policy) cell. Cell (m, p, pol) is stored at index
+    //(m*256 + p)*MAX_POLICIES + pol. Only those four columns are read.
+    void cellTotals(vector<int64_t> & sum, vector<uint64_t> & count)
+    {
+      sum.assign(2*256*MAX_POLICIES, 0);
+      count.assign(2*256*MAX_POLICIES, 0);
+      for (unsigned int b = 0; b < b_data.size(); b++)
+      {
+        const uint8_t* c_mode = mode(b);
+        const uint8_t* c_percent = percent(b);
+        const uint8_t* c_policy = policy(b);
+        const int32_t* c_flow = flow(b);
+        for (uint32_t i = 0; i < b_rows[b]; i++)
+        {
+          if (c_mode[i] < 2 && c_policy[i] < MAX_POLICIES)
+          {
+            int cell = (c_mode[i]*256 + c_percent[i])*MAX_POLICIES +
+                       c_policy[i];
+            sum[cell] += c_flow[i];
+            count[cell]++;
+          }
+        }
+      }
+      return;
+    }
+
+  private:
+    const char* base; //Start of the mapped file
+    size_t length; //Length of the mapped file
+};
+  
+    
+
+///////////////////////////////////////////////////////////////////////////////
+//////////////////////////////GENERAL FUNCTIONS////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+//BREADTH FIRST SEARCH
+//Description: Special version of BFS used in conjuction with the
+//following Max-Flow-Calculating Algorithm. If reach is not NULL, it receives
+//the "visited" status of every node.
+template <class Cap>
+bool bfs(Cap** RG, int s, int t, int* parent, int nodes, bool* reach)
+{
+  queue<int> Q; //Storage queue
+  Q.push(s); //Push starting node into queue
+  bool* visited = new bool[nodes]; //Stores "visited" status on all nodes
+  for (int i = 0; i < nodes; i++) //Set all visited[] -> 0
+  {
+    visited[i] = false;
+  }
+  visited[s] = true;
+  parent[s] = -1; //"NIL"
+  while (Q.empty() == false) //While Q is not empty
+  {
+    int u = Q.front();
+    Q.pop();
+    for (int v = 0; v < nodes; v++)
+    {
+      if (!visited[v] && RG[u][v] > 0)
+      {
+        Q.push(v);
+        parent[v] = u;
+        visited[v] = true;
+      }
+    }
+  }
+  bool storage = visited[t];
+  if (reach != NULL)
+  {
+    memcpy(reach, visited, nodes*sizeof(bool));
+  }
+  delete []visited;
+  return storage;
+}
+
+//FORD FULKERSON'S MAX FLOW CALCULATOR
+//Description: Used to calculate Max Flow. Based off of the Ford
+//Fulkerson Algorithm; this particular implementation is known as the
+//Edmonds-Karp Algorithm.
+template <class Cap>
+int calcMaxFlow(Cap** graph, int s, int t, int nodes)
+{
+  int max_flow = 0; //Max calculated flow
+  int u = 0;
+  int v = 0;
+
+  Cap** RG = new Cap*[nodes]; //Stores Residual Graph
+  for (int i = 0; i < nodes; i++) //Create 2D Array
+  {
+    RG[i] = new Cap[nodes];
+  }
+  for (u = 0; u < nodes; u++) //Copy original graph into RG
+  {
+    for (v = 0; v < nodes; v++)
+    {
+      RG[u][v] = graph[u][v];
+    }
+  }
+  int* parent = new int[nodes]; //Array to store parent nodes
+
+  /*-----MAX FLOW CALCULATION-----*/
+  while (bfs(RG, s, t, parent, nodes))
+  {
+    int path_flow = INT_MAX;
+    for (v = t; v != s; v = parent[v])
+    {
+      u = parent[v];
+      path_flow = min(path_flow, static_cast<int>(RG[u][v]));
+    }
+    for (v = t; v != s; v = parent[v])
+    {
+      u = parent[v];
+      RG[u][v] -= path_flow;
+      RG[v][u] += path_flow;
+    }
+    max_flow += path_flow;
+  }
+
+  /*-----MEMORY CLEANUP-----*/
+  for (int i = 0; i < nodes; i++)
+  {
+    delete []RG[i];
+  }
+  delete []RG;
+  delete []parent;
+  return max_flow;
+}
+
+//TRIAL SEED
+//Description: Derives the seed of a sweep's trial from the sweep's seed, so
+//that any trial can be run again on its own.
+uint32_t trialSeed(const uint32_t seed, const uint64_t trial)
+{
+  uint64_t z = seed + (trial + 1) * 0x9E3779B97F4A7C15ULL; //SplitMix64
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return static_cast<uint32_t>(z ^ (z >> 31));
+}
+
+//CHECKPOINT NAME
+//Description: Returns the name of the checkpoint kept for a result file.
+string checkpointName(const string result_file)
+{
+  return result_file + ".ckpt";
+}
+
+//SAVE CHECKPOINT
+//Description: Records everything needed to continue a sweep: its settings,
+//the running totals and the result writer's state. The totals also hold the
+//number of trials run for each percent, which gives the next trial to run
+//(trial seeds are derived from trial indices). The checkpoint is written to a
+//temporary file first and then renamed, so an interruption while saving
+//leaves the previous checkpoint in place.
+bool saveCheckpoint(SweepSettings & sweep, SweepTotals & totals,
+                    ResultWriter & out)
+{
+  string name = checkpointName(sweep.file);
+  string temp = name + ".tmp";
+  ofstream fout(temp.c_str(), ios::binary | ios::trunc);
+  int32_t values[6] = {sweep.mode, sweep.p_from, sweep.p_to, sweep.p_step,
+                       sweep.trials, sweep.shocks};
+  uint64_t cells = totals.count.size();
+  uint64_t percents = totals.d_sum.size();
+  fout.write(CHECKPOINT_MAGIC, 8);
+  fout.write(reinterpret_cast<char*>(values), sizeof(values));
+  fout.write(reinterpret_cast<char*>(&sweep.target), sizeof(sweep.target));
+  fout.write(reinterpret_cast<char*>(&sweep.seed), sizeof(sweep.seed));
+  fout.write(reinterpret_cast<char*>(&cells), sizeof(cells));
+  fout.write(reinterpret_cast<char*>(&totals.sum[0]), cells*sizeof(double));
+  fout.write(reinterpret_cast<char*>(&totals.sq[0]), cells*sizeof(double));
+  fout.write(reinterpret_cast<char*>(&totals.count[0]),
+             cells*sizeof(uint64_t));
+  fout.write(reinterpret_cast<char*>(&totals.d_sum[0]),
+             percents*sizeof(double));
+  fout.write(reinterpret_cast<char*>(&totals.d_sq[0]),
+             percents*sizeof(double));
+  out.saveState(fout);
+  fout.close();
+  if (!fout || !out.isGood() || rename(temp.c_str(), name.c_str()) != 0)
+  {
+    cout << "Error, could not save checkpoint " << name << endl;
+    return false;
+  }
+  return true;
+}
+
+//LOAD CHECKPOINT
+//Description: Reads the checkpoint of the passed result file. The sweep's
+//settings are always read. The remaining state is only read if totals and
+//out are not NULL, in which case out is brought back to the checkpoint.
+bool loadCheckpoint(const string result_file, SweepSettings & sweep,
+                    SweepTotals* totals, ResultWriter* out)
+{
+  string name = checkpointName(result_file);
+  ifstream fin(name.c_str(), ios::binary);
+  char magic[8];
+  int32_t values[6];
+  if (!fin.read(magic, 8) || memcmp(magic, CHECKPOINT_MAGIC, 8) != 0 ||
+      !fin.read(reinterpret_cast<char*>(values), sizeof(values)) ||
+      !fin.read(reinterpret_cast<char*>(&sweep.target), sizeof(sweep.target)) ||
+      !fin.read(reinterpret_cast<char*>(&sweep.seed), sizeof(sweep.seed)))
+  {
+    return false;
+  }
+  sweep.mode = values[0];
+  sweep.p_from = values[1];
+  sweep.p_to = values[2];
+  sweep.p_step = values[3];
+  sweep.trials = values[4];
+  sweep.shocks = values[5];
+  sweep.file = result_file;
+  if (sweep.p_from < 0 || sweep.p_from > sweep.p_to || sweep.p_to > 100 ||
+      sweep.p_step < 1 || sweep.trials < 1)
+  {
+    return false;
+  }
+  if (totals == NULL || out == NULL)
+  {
+    return true;
+  }
+  uint64_t cells = 0;
+  uint64_t percents = sweep.getPC();
+  if (!fin.read(reinterpret_cast<char*>(&cells), sizeof(cells)) ||
+      cells != percents * POLICIES)
+  {
+    return false;
+  }
+  totals->reset(percents);
+  fin.read(reinterpret_cast<char*>(&totals->sum[0]), cells*sizeof(double));
+  fin.read(reinterpret_cast<char*>(&totals->sq[0]), cells*sizeof(double));
+  fin.read(reinterpret_cast<char*>(&totals->count[0]),
+           cells*sizeof(uint64_t));
+  fin.read(reinterpret_cast<char*>(&totals->d_sum[0]),
+           percents*sizeof(double));
+  fin.read(reinterpret_cast<char*>(&totals->d_sq[0]),
+           percents*sizeof(double));
+  return fin && out->loadState(fin);
+}
+
+//BACKOFF
+//Description: Waits once, for the n-th time in a row, while another thread
+//gets something ready. The thread first yields, then sleeps for short
+//periods, so it does not take CPU time from the threads it waits for.
+void backoff(const int n)
+{
+  if (n < 64)
+  {
+    this_thread::yield();
+  }
+  else
+  {
+    this_thread::sleep_for(chrono::microseconds(500));
+  }
+  return;
+}
+
+//ON INTERRUPT
+//Description: Signal handler used during sweeps. The sweep saves a
+//checkpoint and stops after its current trial.
+void onInterrupt(int)
+{
+  interrupted = 1;
+  return;
+}
+
+//PARSING FUNCTION
+//Description: Reads from the input file, and creates the actual network.
+//Must contain at least two nodes and one edge.
+template <class Cap>
+void parseGML(Network<Cap> & comm_net)
+{
+  string storage = "empty"; //Storage string
+  Node* temp_node; //Pointer to Node
+  Link* temp_link; //Pointer to Link
+  bool lcv = true; //Boolean to control loops
+  ifstream fin;
+  fin.open(FILENAME.c_str());
+  /*-----SEARCH FOR START OF NODE LIST-----*/
+  while(storage != "node") //When "node" is read, the node list has begun
+  {
+    fin >> storage;
+  }
+  /*-----BEGIN FORMING NODES-----*/
+  float x = 0; //Stores Latitude
+  float y = 0; //Stores Longitude
+  while(storage != "edge") //When "edge is read", the edge list has begun
+  {
+    while(storage != "Longitude" && lcv)
+    {
+      fin >> storage;
+      if (storage == "hyperedge")
+      {
+        lcv = false;
+      }
+    }
+    if(lcv)
+    {
+      fin >> y;
+    }
+    while(storage != "Latitude" && lcv)
+    {
+      fin >> storage;
+    }
+    if (storage != "Latitude") //Hyperedges do not have coordinates.
+    { //So, a generic coordinate near the center of the system is used.
+      x = 40;
+      y = -90;
+    }
+    else
+    {
+      fin >> x;
+    }
+    temp_node = new Node(x,y);
+    comm_net.v_node.push_back(*temp_node);
+    comm_net.node_count++;
+    delete temp_node;
+    temp_node = NULL;
+    lcv = true;
+    while(storage != "node" && storage != "edge")
+    {
+      fin >> storage;
+    }
+  }
+
+  //*-----ADJACENCY MATRIX CREATION-----*/
+  comm_net.AM = new Cap*[comm_net.node_count];
+  for (int i = 0; i < comm_net.node_count; i++)
+  {
+    comm_net.AM[i] = new Cap[comm_net.node_count];
+    for (int j = 0; j < comm_net.node_count; j++)
+    {
+      comm_net.AM[i][j] = 0;
+    }
+  }
+
+  /*-----BEGIN FORMING LINKS-----*/
+  int s = 0; //Stores Link's first node
+  int e = 0; //Stores Link's other node
+  x = 0;
+  y = 0;  
+  while(lcv)
+  {
+    while(storage != "edge")
+    {
+      fin >> storage;
+    }
+    while(storage != "source")
+    {
+      fin >> storage;
+    }
+    fin >> s;
+    while(storage != "target")
+    {
+      fin >> storage;
+    }
+    fin >> e;
+
+    /*-----CALCULATE X AND Y FOR LINK-----*/
+    x = (comm_net.v_node[s].getXP() + comm_net.v_node[e].getXP())/2;
+    y = (comm_net.v_node[s].getYP() + comm_net.v_node[e].getYP())/2;
+    temp_link = new Link(s,e,x,y); //Start, End, X-Coord, Y-Coord.
+    comm_net.v_link.push_back(*temp_link);
+    comm_net.link_count++;
+    comm_net.AM[s][e] = temp_link->getCAP();
+    comm_net.AM[e][s] = temp_link->getCAP();
+    delete temp_link;
+    temp_link = NULL;
+    while(storage != "]")
+    {
+      fin >> storage;
+    }
+    fin >> storage;
+    if (storage == "]")
+    {
+      lcv = false;
+    }
+  }
+
+  /*-----CALCULATE BARYCENTER-----*/
+  float bary_x = 0;
+  float bary_y = 0;
+  for (int i = 0; i < comm_net.getNC(); i++)
+  {
+    bary_x += comm_net.v_node[i].getXP();
+    bary_y += comm_net.v_node[i].getYP();
+  }
+  comm_net.b_x = bary_x / comm_net.getNC();
+  comm_net.b_y = bary_y / comm_net.getNC();
+  comm_net.kernel.build(comm_net.v_node, comm_net.v_link);
+  fin.close();
+  return;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////REPAIR POLICIES/////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+//Description: A repair policy is any class with a member function
+//  void repair(Network<Cap> & comm_net)
+//for the capacity type Cap of the Network it repairs. It is called once per
+//time step, completes any finished repair and, when the crew is free,
+//schedules the next one. A policy that works for any capacity type makes
+//repair() a member template (RandomRepair, GreedyRepair); one that keeps
+//state tied to the capacity type is a class template instead
+//(GainRepair<Cap>). Policies are passed to simulate() as template
+//arguments, so their calls are resolved at compile time and new strategies
+//do not need their own copy of the simulation loop.
+
+///////////////////
+///RANDOM REPAIR///
+///////////////////
+
+//Description: Implementation of Random Algorithm. Schedules a random broken
+//component for repairs if no other components are currently being repaired.
+class RandomRepair
+{
+  public:
+    //CONSTRUCTOR
+    //Description: Draws from rand() until reseed() is called.
+    RandomRepair()
+    {
+      r_own = false;
+      r_state = 0;
+    }
+
+    //RESEED
+    //Description: Makes the policy draw from its own generator, starting at
+    //seed, so copies of the policy on other threads never share rand().
+    void reseed(const uint32_t seed)
+    {
+      r_own = true;
+      r_state = seed;
+      return;
+    }
+
+    template <class Cap>
+    void repair(Network<Cap> & comm_net)
+    {
+      if (comm_net.RRT != 0)
+      {
+        return;
+      }
+      else //The network is not currently repairing anything else
+      {
+        if (comm_net.LR || comm_net.NR || comm_net.SR)
+        {
+          comm_net.progress(); //Completes scheduled repair
+        }
+        int repair_count = -1; //Stores amount of repairs to be made
+        repair_count = comm_net.getNB() + comm_net.getLB();
+        int midpoint = comm_net.getNB();
+        if (repair_count == 0) //No repairs are necessary
+        {
+          return;
+        }
+        int selection = (draw()%repair_count)+1;
+        bool searching = true; //Controls loops that search for broken parts
+        if (selection <= midpoint) //A node will be repaired
+        {
+          while(searching)
+          {
+            selection = (draw()%comm_net.getNC());
+            if (comm_net.v_node[selection].broken == true)
+            {
+              comm_net.repairNode(selection); //Schedule Node Repair
+              searching = false;
+            }
+          }
+        }
+        else //A link will be repaired
+        {
+          while(searching)
+          {
+            selection = (draw()%comm_net.getLC());
+            if (comm_net.v_link[selection].broken == true)
+            {
+              comm_net.repairLink(selection); //Schedule Link Repair
+              searching = false;
+            }
+          }
+        }
+        return;
+      }
+    }
+
+  private:
+    bool r_own; //True if the policy draws from its own generator
+    uint32_t r_state; //State of the policy's generator
+
+    //DRAW
+    //Description: Returns the next value of the policy's generator, in the
+    //range of rand().
+    int draw()
+    {
+      if (!r_own)
+      {
+        return rand();
+      }
+      r_state += 0x9e3779b9;
+      return FailureKernel::hash32(r_state) & RAND_MAX;
+    }
+};
+
+///////////////////
+///GREEDY REPAIR///
+///////////////////
+
+//Description: Implementation of the Algorithm designed in the report.
+//The "ERV" for some Link is the ratio formed by the capacity of the link
+//divided by the time to repair the link and the two nodes tied to it.
+//If the link or either of the nodes are already functional, then their
+//repair time is not added into this ratio.
+class GreedyRepair
+{
+  public:
+    template <class Cap>
+    void repair(Network<Cap> & comm_net)
+    {
+      if (comm_net.RRT != 0)
+      {
+        return;
+      }
+      else //The network is not currently repairing anything else
+      {
+        if (comm_net.LR || comm_net.NR || comm_net.SR)
+        {
+          comm_net.progress(); //Completes scheduled repair
+        }
+        int repair_count = comm_net.getNB() + comm_net.getLB();
+        if (repair_count == 0) //No repairs are necessary
+        {
+          return;
+        }
+        comm_net.smartRepair(choose(comm_net));
+        return;
+      }
+    }
+
+    //CHOOSE
+    //Description: Returns the unconnected Link with the highest ERV.
+    template <class Cap>
+    int choose(Network<Cap> & comm_net)
+    {
+      float temp_ERV = 0;
+      float max_ERV = -1;
+      float duration = -1;
+      int ERV_index = -1;
+      for (int l = 0; l < comm_net.getLC(); l++)
+      {
+        if (comm_net.v_link[l].connected == false)
+        {
+          duration = comm_net.calcSRT(l);
+          temp_ERV =
+            (static_cast<float>(comm_net.v_link[l].getCAP())/duration);
+          if (temp_ERV > max_ERV)
+          {
+            max_ERV = temp_ERV;
+            ERV_index = l;
+          }
+        }
+      }
+      return ERV_index;
+    }
+};
+
+/////////////////
+///GAIN REPAIR///
+/////////////////
+
+//Description: Schedules the smart repair that adds the most Max Flow per unit
+//of repair time. The current flow is the one kept by the reduced graph.
+//Only Links whose repair grows an arc crossing the current minimum cut can
+//raise the flow, so all other Links are skipped. Every remaining candidate is
+//tried on a copy of the current residual graph, split across worker threads.
+//If no single repair raises the flow, the ERV rule of GreedyRepair is used.
+template <class Cap>
+class GainRepair
+{
+  public:
+    //CONSTRUCTOR
+    //Description: workers is the number of threads used to evaluate
+    //candidates. If it is 0, one thread per available core is used.
+    GainRepair(int workers = 0)
+    {
+      w_count = workers;
+      if (w_count <= 0)
+      {
+        w_count = thread::hardware_concurrency();
+      }
+      if (w_count <= 0)
+      {
+        w_count = 1;
+      }
+      base = NULL;
+      b_gain = 0;
+    }
+
+    //DESTRUCTOR
+    ~GainRepair()
+    {
+      clearFlow();
+    }
+
+    void repair(Network<Cap> & comm_net)
+    {
+      if (comm_net.RRT != 0)
+      {
+        return;
+      }
+      else //The network is not currently repairing anything else
+      {
+        if (comm_net.LR || comm_net.NR || comm_net.SR)
+        {
+          comm_net.progress(); //Completes scheduled repair
+        }
+        int repair_count = comm_net.getNB() + comm_net.getLB();
+        if (repair_count == 0) //No repairs are necessary
+        {
+          return;
+        }
+        comm_net.smartRepair(best(comm_net));
+        return;
+      }
+    }
+
+    //BEST
+    //Description: Returns the Link whose smart repair should come next, or
+    //-1 if no Link is unconnected. The flow it adds is kept in b_gain.
+    int best(Network<Cap> & comm_net)
+    {
+      if (comm_net.reduced == NULL)
+      {
+        comm_net.reduce(SRCID, DSTID);
+      }
+      int index = -1;
+      b_gain = 0;
+      if (comm_net.reduced->RAM != NULL) //An s-t path can exist
+      {
+        index = choose(comm_net);
+      }
+      if (index == -1) //No single repair raises the flow
+      {
+        GreedyRepair fallback;
+        index = fallback.choose(comm_net);
+      }
+      return index;
+    }
+
+    //ACCESSOR FUNCTIONS
+    int getGain(){return b_gain;}
+
+  private:
+    int w_count; //Number of worker threads
+    FlowState<Cap>* base; //Flow of the network before the next repair
+    vector<FlowState<Cap>*> scratch; //Private residual graph of each worker
+    vector< vector<int> > n_link; //Links attached to each Node
+    vector<int> cand; //Candidate Links crossing the minimum cut
+    vector<int> c_off; //Start of each candidate's arc changes in c_delta
+    vector<int> c_delta; //Arc changes (a,b,added capacity) of all candidates
+    vector<int> gain; //Flow gained by each candidate
+    int b_gain; //Flow gained by the Link last returned by best()
+
+    //CLEAR FLOW
+    //Description: Releases the workers' copies of the current flow.
+    void clearFlow()
+    {
+      for (unsigned int w = 0; w < scratch.size(); w++)
+      {
+        delete scratch[w];
+      }
+      scratch.clear();
+      return;
+    }
+
+    //CHOOSE
+    //Description: Returns the candidate with the highest flow gain per unit
+    //of repair time, or -1 if no candidate raises the flow.
+    int choose(Network<Cap> & comm_net)
+    {
+      ReducedGraph<Cap> & red = *comm_net.reduced;
+
+      /*-----WARM START-----*/
+      red.calcFlow(); //Brings the kept flow up to date
+      base = red.state;
+      if (scratch.empty() || scratch[0]->nodes != base->nodes ||
+          scratch[0]->src != base->src || scratch[0]->dst != base->dst)
+      {
+        clearFlow();
+        for (int w = 0; w < w_count; w++)
+        {
+          scratch.push_back(new FlowState<Cap>(*base));
+        }
+      }
+      if (static_cast<int>(n_link.size()) != comm_net.getNC())
+      {
+        n_link.assign(comm_net.getNC(), vector<int>());
+        for (int k = 0; k < comm_net.getLC(); k++)
+        {
+          n_link[comm_net.v_link[k].getSI()].push_back(k);
+          n_link[comm_net.v_link[k].getEI()].push_back(k);
+        }
+      }
+
+      /*-----CANDIDATES CROSSING THE MINIMUM CUT-----*/
+      bool* reach = new bool[red.r_count]; //Source side of the minimum cut
+      base->reachable(reach);
+      vector<int> r_links; //Links restored by one smart repair
+      cand.clear();
+      c_off.clear();
+      c_delta.clear();
+      for (int l = 0; l < comm_net.getLC(); l++)
+      {
+        if (comm_net.v_link[l].connected == false)
+        {
+          int start = c_delta.size();
+          restored(comm_net, l, r_links);
+          arcChanges(comm_net, r_links);
+          bool crossing = false;
+          for (unsigned int i = start; i < c_delta.size(); i += 3)
+          {
+            if (reach[c_delta[i]] != reach[c_delta[i+1]])
+            {
+              crossing = true;
+            }
+          }
+          if (crossing)
+          {
+            cand.push_back(l);
+            c_off.push_back(start);
+          }
+          else
+          {
+            c_delta.resize(start);
+          }
+        }
+      }
+      c_off.push_back(c_delta.size());
+      delete []reach;
+
+      /*-----PARALLEL EVALUATION-----*/
+      //Starting a thread costs about as much as evaluating a few candidates,
+      //so each thread gets at least GAIN_SHARE of them. Most decisions have
+      //fewer than that, and are evaluated on the calling thread alone.
+      int c_count = cand.size();
+      gain.assign(c_count, 0);
+      int used = max(1, min(w_count, c_count / GAIN_SHARE)); //Threads used
+      int per = (c_count + used - 1) / used; //Candidates per thread
+      vector<thread> pool;
+      for (int w = 1; w < used && w*per < c_count; w++)
+      {
+        pool.push_back(thread(&GainRepair::evaluate, this, w, w*per,
+                              min(c_count, (w+1)*per)));
+      }
+      evaluate(0, 0, min(c_count, per));
+      for (unsigned int w = 0; w < pool.size(); w++)
+      {
+        pool[w].join();
+      }
+
+      /*-----SELECTION-----*/
+      float top = 0;
+      int index = -1;
+      for (int c = 0; c < c_count; c++)
+      {
+        if (gain[c] > 0)
+        {
+          float score = static_cast<float>(gain[c]) / comm_net.calcSRT(cand[c]);
+          if (score > top)
+          {
+            top = score;
+            index = cand[c];
+            b_gain = gain[c];
+          }
+        }
+      }
+      return index;
+    }
+
+    //EVALUATE
+    //Description: Run by worker w. Finds the flow gained by candidates
+    //first..last-1, starting each one from the current flow.
+    void evaluate(const int w, const int first, const int last)
+    {
+      FlowState<Cap> & f = *scratch[w];
+      for (int c = first; c < last; c++)
+      {
+        f.copyFrom(*base);
+        for (int i = c_off[c]; i < c_off[c+1]; i += 3)
+        {
+          f.RG[c_delta[i]][c_delta[i+1]] += c_delta[i+2];
+          f.RG[c_delta[i+1]][c_delta[i]] += c_delta[i+2];
+        }
+        gain[c] = f.augment();
+      }
+      return;
+    }
+
+    //RESTORED
+    //Description: Fills out with every Link that becomes connected if Link l
+    //and its broken nodes are repaired, in increasing order.
+    void restored(Network<Cap> & comm_net, const int l, vector<int> & out)
+    {
+      int s = comm_net.v_link[l].getSI();
+      int e = comm_net.v_link[l].getEI();
+      int ends[2] = {s, e};
+      out.clear();
+      out.push_back(l);
+      for (int i = 0; i < 2; i++)
+      {
+        if (!comm_net.v_node[ends[i]].broken || (i == 1 && s == e))
+        {
+          continue;
+        }
+        for (unsigned int j = 0; j < n_link[ends[i]].size(); j++)
+        {
+          int k = n_link[ends[i]][j];
+          Link & link = comm_net.v_link[k];
+          int other = (link.getSI() == ends[i] ? link.getEI() : link.getSI());
+          if (k != l && !link.connected && !link.broken &&
+              (!comm_net.v_node[other].broken || other == s || other == e))
+          {
+            out.push_back(k);
+          }
+        }
+      }
+      sort(out.begin(), out.end());
+      out.erase(unique(out.begin(), out.end()), out.end());
+      return;
+    }
+
+    //ARC CHANGES
+    //Description: Appends the capacity that each reduced arc gains when the
+    //passed Links are connected. The new capacities follow connect(), where a
+    //later Link between the same two nodes overwrites an earlier one. Arcs
+    //that would shrink through such an overwrite are left out.
+    void arcChanges(Network<Cap> & comm_net, vector<int> & r_links)
+    {
+      ReducedGraph<Cap> & red = *comm_net.reduced;
+      vector<int> arcs; //Arcs touched by the restored Links
+      vector<int> added; //Capacity added to each touched arc
+      vector<int> chains; //Chains already counted
+      for (unsigned int i = 0; i < r_links.size(); i++)
+      {
+        int c = red.l_chain[r_links[i]];
+        if (c == -1 || find(chains.begin(), chains.end(), c) != chains.end())
+        {
+          continue;
+        }
+        chains.push_back(c);
+        int cap = INT_MAX; //Chain's capacity once the Links are connected
+        for (unsigned int j = 0; j < red.c_edge[c].size(); j += 2)
+        {
+          int u = red.c_edge[c][j];
+          int v = red.c_edge[c][j+1];
+          int val = comm_net.AM[u][v];
+          for (unsigned int k = 0; k < r_links.size(); k++)
+          {
+            Link & link = comm_net.v_link[r_links[k]];
+            if ((link.getSI() == u && link.getEI() == v) ||
+                (link.getSI() == v && link.getEI() == u))
+            {
+              val = link.getCAP();
+            }
+          }
+          cap = min(cap, val);
+        }
+        int arc = red.c_arc[c];
+        unsigned int a = find(arcs.begin(), arcs.end(), arc) - arcs.begin();
+        if (a == arcs.size())
+        {
+          arcs.push_back(arc);
+          added.push_back(0);
+        }
+        added[a] += cap - red.c_cap[c];
+      }
+      for (unsigned int a = 0; a < arcs.size(); a++)
+      {
+        if (added[a] > 0)
+        {
+          c_delta.push_back(red.a_s[arcs[a]]);
+          c_delta.push_back(red.a_e[arcs[a]]);
+          c_delta.push_back(added[a]);
+        }
+      }
+      return;
+    }
+};
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////NETWORK SERVICE/////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+//Description: Keeps one Network and its s-t flow in memory and answers
+//requests about it, one per line, read from stdin or a Unix domain socket.
+//Events change the state of a component and get no reply:
+//  fail node <i>    fail link <i>    repair node <i>    repair link <i>
+//Queries get one line each:
+//  flow     -> flow <Max Flow between SRCID and DSTID>
+//  next     -> next <Link> <flow gained> <repair time>, or next none
+//  status   -> status <broken Nodes> <broken Links>
+//  quit     -> ends the session (the socket's client is disconnected)
+//  shutdown -> stops the service
+//Events only mark components. The Links and the flow are brought up to date
+//when the next query arrives, so events sent together cost a single pass.
+//Replies are written once all requests that arrived together are handled.
+template <class Cap>
+class NetworkService
+{
+  public:
+    //CONSTRUCTOR
+    NetworkService(Network<Cap> & comm_net) : net(comm_net)
+    {
+      pending = false;
+    }
+
+    //SERVE STDIN
+    //Description: Handles requests from stdin until it closes or the session
+    //ends, in the same way as a client's requests, and replies on stdout.
+    //Input that cin has already read ahead is handled first, so cin must not
+    //be synced with stdio, which would keep that input out of reach.
+    void serveStdin()
+    {
+      string head(max<streamsize>(0, cin.rdbuf()->in_avail()), '\0');
+      if (!head.empty())
+      {
+        head.resize(cin.rdbuf()->sgetn(&head[0], head.size()));
+      }
+      cout << flush;
+      serveClient(STDIN_FILENO, STDOUT_FILENO, head);
+      return;
+    }
+
+    //SERVE SOCKET
+    //Description: Listens on a Unix domain socket at path and serves one
+    //client at a time until a client sends shutdown. Returns false if the
+    //socket could not be opened or stopped accepting clients.
+    bool serveSocket(const string path)
+    {
+      sockaddr_un addr;
+      memset(&addr, 0, sizeof(addr));
+      if (path.size() >= sizeof(addr.sun_path))
+      {
+        return false;
+      }
+      addr.sun_family = AF_UNIX;
+      strcpy(addr.sun_path, path.c_str());
+      int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+      if (sock < 0)
+      {
+        return false;
+      }
+      unlink(path.c_str());
+      if (bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+          listen(sock, 8) != 0)
+      {
+        close(sock);
+        return false;
+      }
+      signal(SIGPIPE, SIG_IGN); //A client that leaves must not end the service
+      cerr << "Listening on " << path << endl;
+      int state = 0;
+      while (state != 2)
+      {
+        int fd = accept(sock, NULL, NULL);
+        if (fd >= 0)
+        {
+          state = serveClient(fd, fd, "");
+          close(fd);
+        }
+        else if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS ||
+                 errno == ENOMEM) //Out of resources; wait for some to free
+        {
+          this_thread::sleep_for(chrono::milliseconds(100));
+        }
+        else if (errno != EINTR && errno != ECONNABORTED)
+        {
+          cerr << "Error, accept failed: " << strerror(errno) << endl;
+          break;
+        }
+      }
+      close(sock);
+      unlink(path.c_str());
+      return state == 2;
+    }
+
+  private:
+    Network<Cap> & net; //Network kept by the service
+    GainRepair<Cap> planner; //Chooses the next repair
+    bool pending; //True if events were applied since the Links were updated
+
+    //SERVE CLIENT
+    //Description: Handles requests read from in_fd, starting with the input
+    //in head, and writes the replies to out_fd. Every read may hold many
+    //requests, and their replies are sent back together. Returns the state
+    //of the session when it ended.
+    int serveClient(const int in_fd, const int out_fd, const string head)
+    {
+      char buf[65536];
+      string line;
+      string out;
+      int state = 0;
+      const char* data = head.data(); //Input still to be handled
+      ssize_t n = head.size();
+      while (state == 0)
+      {
+        if (n <= 0)
+        {
+          data = buf;
+          n = read(in_fd, buf, sizeof(buf));
+          if (n <= 0)
+          {
+            break;
           }
         }
-        else //Link is marked as connected
+        for (ssize_t i = 0; i < n && state == 0; i++)
         {
-          if (v_node[v_link[k].getSI()].broken ||
-              v_node[v_link[k].getEI()].broken ||
-              v_link[k].broken)
-          //If either nodes is broken or the link itself is broken
+          if (data[i] == '\n')
           {
-            v_link[k].connected = false;
-            AM[v_link[k].getSI()][v_link[k].getEI()] = 0;
-            AM[v_link[k].getEI()][v_link[k].getSI()] = 0;
+            state = request(line, out);
+            line.clear();
+          }
+          else
+          {
+            line += data[i];
+          }
+        }
+        for (size_t sent = 0; sent < out.size(); )
+        {
+          ssize_t w = write(out_fd, out.data() + sent, out.size() - sent);
+          if (w <= 0)
+          {
+            return state;
           }
+          sent += w;
         }
+        out.clear();
+        n = 0;
       }
-      return;
+      return state;
     }
 
-    //RANDOM FAILING FUNCTION
-    //Description: Based on the % passed, breaks sensors and links.
-    void randomFail(const int percent)
+    //REQUEST
+    //Description: Handles one request line and appends its reply, if any, to
+    //out. Returns 0 to go on, 1 to end the session, 2 to stop the service.
+    int request(const string & line, string & out)
     {
-      int temp = 0;
-      for (int i = 0; i < node_count; i++)
+      istringstream in(line);
+      string cmd;
+      if (!(in >> cmd)) //Blank line
       {
-        temp = (rand()%100)+1;
-        if (temp <= percent)
+        return 0;
+      }
+      if (cmd == "fail" || cmd == "repair")
+      {
+        string kind;
+        int index = -1;
+        in >> kind >> index;
+        bool node = (kind == "node");
+        int count = (node ? net.getNC() : net.getLC());
+        if ((!node && kind != "link") || in.fail() || index < 0 ||
+            index >= count)
+        {
+          out += "error " + line + "\n";
+          return 0;
+        }
+        bool broken = (cmd == "fail");
+        if (node ? net.setNode(index, broken) : net.setLink(index, broken))
         {
-          v_node[i].broken = true;
-          nodes_broken++;
+          pending = true;
         }
+        return 0;
       }
-      for (int i = 0; i < link_count; i++)
+      if (pending) //Applies every event since the last query at once
+      {
+        net.connect();
+        pending = false;
+      }
+      ostringstream reply;
+      if (cmd == "flow")
+      {
+        reply << "flow " << net.flow(SRCID, DSTID);
+      }
+      else if (cmd == "next")
       {
-        temp = (rand()%100)+1;
-        if (temp <= percent)
+        int l = -1;
+        if (net.getNB() + net.getLB() != 0)
+        {
+          l = planner.best(net);
+        }
+        if (l == -1)
+        {
+          reply << "next none";
+        }
+        else
         {
-          v_link[i].broken = true;
-          links_broken++;
+          reply << "next " << l << " " << planner.getGain() << " "
+                << net.calcSRT(l);
         }
       }
-      connect();
-      return;
+      else if (cmd == "status")
+      {
+        reply << "status " << net.getNB() << " " << net.getLB();
+      }
+      else if (cmd == "quit")
+      {
+        return 1;
+      }
+      else if (cmd == "shutdown")
+      {
+        return 2;
+      }
+      else
+      {
+        reply << "error " << line;
+      }
+      out += reply.str() + "\n";
+      return 0;
     }
+};
 
-    //GEOGRAPHIC FAILING FUNCTION
-    //Description: Based on a circular region that contains all nodes, breaks
-    //nodes within the passed % of the the regions's radius.
-    void geoFail(const float percent)
+///////////////////////////////////////////////////////////////////////////////
+//////////////////////////////SIMULATION FUNCTIONS/////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+//SIMULATE
+//Description: Repairs the passed Network with the passed policy until no
+//damage is left. The flow is recorded ITV times over the estimated repair
+//time est_t, and once more when all repairs are finished. flow must hold
+//ITV+1 values, and is expected to be filled with the optimal flow already.
+//If when is not NULL, it receives the time of every recorded value.
+//If events is not NULL, its failures are applied as their times arrive, for
+//as long as the network is still damaged.
+template <class Policy, class Cap>
+void simulate(Network<Cap> & comm_net, Policy & policy, const int est_t,
+              int* flow, int* when = NULL, FailureSchedule* events = NULL)
+{
+  int clock = 0; //Stores time passed
+  int rec_c = 0; //Stores number of recorded values
+  int next = 0; //Next failure event
+  while(comm_net.assessDamage() != 0)
+  {
+    if (events != NULL)
     {
-      float x = 0;
-      float y = 0;
-      float radq = 0; //Stores Radius Squared
-      float rmax = -1;
+      next = events->apply(comm_net, clock, next);
+    }
+    policy.repair(comm_net);
+    if (comm_net.RRT > 0) //If there are still repairs left
+    {
+      comm_net.RRT--;
+    }
+    if (rec_c < ITV && clock == (rec_c*(est_t/(ITV))))
+    //If an interval was reached
+    {
+      flow[rec_c] = comm_net.flow(SRCID, DSTID); //Record data values
+      if (when != NULL)
+      {
+        when[rec_c] = clock;
+      }
+      rec_c++;
+    }
+    if (comm_net.assessDamage() == 0) //Stores last values
+    {
+      flow[ITV] = comm_net.flow(SRCID, DSTID);
+      if (when != NULL)
+      {
+        when[ITV] = clock;
+      }
+    }
+    clock++;
+  }
+  return;
+}
+
+//RUN EXPERIMENT
+//Description: Repairs three copies of the damaged Network, one with each
+//policy, and prints the recorded flows. Cap is the integer type used for
+//capacities during the simulations. percent is the failure percent used to
+//damage the Network, and shocks is the number of aftershocks that arrive
+//during the repairs.
+template <class Cap>
+void runExperiment(Network<int> & damaged, const int max_flow,
+                   const int percent, const int shocks)
+{
+  Network<Cap> randNet(damaged);
+  Network<Cap> algNet(damaged);
+  Network<Cap> gainNet(damaged);
+  RandomRepair randPolicy;
+  GreedyRepair algPolicy;
+  GainRepair<Cap> gainPolicy;
+
+  /*-----EXPERIMENTS-----*/
+  int est_t = randNet.assessDamage(); //Stores time to recover full network
+  FailureSchedule events; //Stores failures arriving during the repairs
+  events.plan(randNet, shocks, percent, est_t);
+  int* RNflow = new int[ITV+1]; //Stores Random Algorithm Flow Measurements
+  int* ANflow = new int[ITV+1]; //Stores Greedy Algorithm flow Measurements
+  int* GNflow = new int[ITV+1]; //Stores Gain Algorithm flow Measurements
+  for (int i = 0; i < ITV+1; i++) //Fills out initial flow values
+  {
+    RNflow[i] = max_flow; //Default flow is optimal
+    ANflow[i] = max_flow; //Default flow is optimal
+    GNflow[i] = max_flow; //Default flow is optimal
+  }
+  //RANDOM ALGORITHM TESTING
+  simulate(randNet, randPolicy, est_t, RNflow, NULL, &events);
+  //GREEDY ALGORITHM TESTING
+  simulate(algNet, algPolicy, est_t, ANflow, NULL, &events);
+  //GAIN ALGORITHM TESTING
+  simulate(gainNet, gainPolicy, est_t, GNflow, NULL, &events);
   
-      /*-----CALCULATING RADIUS-----*/
-      for (int i = 0; i < node_count; i++)
+  /*-----OUTPUT-----*/
+  float avgR = 0;
+  float avgA = 0;
+  float avgG = 0;
+  cout << "Flow Analysis: " << endl;
+  cout << "(R,A,G)" << endl;
+  for (int i = 0; i <= ITV; i++)
+  {
+    cout << "(" << RNflow[i] << "," << ANflow[i] << "," << GNflow[i] << ")"
+         << endl;
+    avgR += RNflow[i];
+    avgA += ANflow[i];
+    avgG += GNflow[i];
+  }
+  avgR /= (ITV+1);
+  avgA /= (ITV+1);
+  avgG /= (ITV+1);
+  cout << "Random Algorithm's Average Flow: " << avgR << endl;
+  cout << "Greedy Algorithm's Average Flow: " << avgA << endl;
+  cout << "Gain Algorithm's Average Flow: " << avgG << endl;
+
+  /*-----DATA CLEANUP-----*/
+  delete []GNflow;
+  delete []ANflow;
+  delete []RNflow;
+  return;
+}
+
+
+
+//RUN TRIAL
+//Description: Repairs a copy of the damaged Network with the passed policy,
+//while the planned failure events arrive. The ITV+1 recorded flows and their
+//times are stored in flow and when. Returns the average of the recorded
+//flows.
+template <class Policy, class Cap>
+double runTrial(Network<Cap> & damaged, FailureSchedule & events,
+                Policy & policy, const int max_flow, int* flow, int* when)
+{
+  Network<Cap> comm_net(damaged);
+  int est_t = comm_net.assessDamage();
+  for (int i = 0; i < ITV+1; i++)
+  {
+    flow[i] = max_flow; //Default flow is optimal
+    when[i] = i*(est_t/ITV);
+  }
+  simulate(comm_net, policy, est_t, flow, when, &events);
+  double avg = 0;
+  for (int i = 0; i < ITV+1; i++)
+  {
+    avg += flow[i];
+  }
+  return avg / (ITV+1);
+}
+
+//PERCENT DONE
+//Description: Returns true once no more trials are needed for the sweep's
+//i-th percent. Adaptive sweeps only check their confidence interval at the
+//end of a batch, so that a resumed sweep stops at the same trial.
+bool percentDone(SweepSettings & sweep, SweepTotals & totals, const int i)
+{
+  uint64_t n = totals.trials(i);
+  if (n >= static_cast<uint64_t>(sweep.trials))
+  {
+    return true;
+  }
+  return sweep.target > 0 && n >= ADAPT_MIN && n % sweep.getBatch() == 0 &&
+         totals.width(i) < sweep.target;
+}
+
+//SWEEP SCENARIO
+//Description: One trial of a sweep on its way through a SweepPipeline. The
+//generator fills in the damaged Network and its failure events, workers fill
+//in the flows of each policy, and the aggregator stores them.
+template <class Cap>
+struct SweepScenario
+{
+  uint64_t order; //Position of the scenario among the generated ones
+  uint64_t trial; //ID of the trial
+  uint32_t seed; //Seed of the trial
+  int index; //Index of the trial's percent in the sweep
+  int percent; //Failure percent
+  uint32_t r_seed; //Seed of RandomRepair's generator
+  atomic<int> left; //Policies not simulated yet
+  Network<Cap> damaged; //Network after the first failure
+  FailureSchedule events; //Failures arriving during the repairs
+  int flow[POLICIES][ITV+1]; //Recorded flows of every policy
+  int when[POLICIES][ITV+1]; //Times of the recorded flows
+  double avg[POLICIES]; //Average flow of every policy
+
+  SweepScenario(Network<int> & base) : left(POLICIES), damaged(base) {}
+};
+
+//SWEEP TASK
+//Description: Simulation of one policy on one scenario. A NULL scenario
+//tells the worker that takes it to stop.
+template <class Cap>
+struct SweepTask
+{
+  SweepScenario<Cap>* scn; //Scenario to repair
+  int policy; //ID of the policy to repair it with
+};
+
+//SWEEP PIPELINE
+//Description: Runs the trials of a sweep in stages that work at the same
+//time. A generator thread damages a copy of the Network for every trial,
+//plans its failure events, and queues one task per policy. A pool of
+//workers, one per available core, takes tasks from any scenario, so the
+//policies of a trial are simulated concurrently and a slow policy does not
+//leave the other workers idle. The worker that finishes a scenario's last
+//policy passes it to the aggregator, on the calling thread. Scenarios finish
+//out of order, so the aggregator puts them back in the order they were
+//generated, then stores the results, adds them to the totals and saves
+//checkpoints. At most w_count + PIPE_DEPTH scenarios are in flight, so
+//every worker has work while memory stays bounded.
+//The trials are generated in the rounds described in runSweep(). Before an
+//adaptive sweep decides whether a percent needs another batch, the generator
+//waits for that percent's last batch to be stored; the percents in between
+//keep the workers busy meanwhile.
+template <class Cap>
+class SweepPipeline
+{
+  public:
+    //CONSTRUCTOR
+    SweepPipeline(SweepSettings & s, Network<int> & b, const int m,
+                  SweepTotals & t, ResultWriter & o)
+      : sweep(s), base(b), max_flow(m), totals(t), out(o)
+    {
+      w_count = thread::hardware_concurrency();
+      if (w_count <= 0)
+      {
+        w_count = 1;
+      }
+      window = w_count + PIPE_DEPTH;
+      todo = new RingQueue<SweepTask<Cap> >(window * POLICIES + w_count);
+      done = new RingQueue<SweepScenario<Cap>*>(window + 1);
+      stored = new atomic<uint64_t>[sweep.getPC()];
+      for (int i = 0; i < sweep.getPC(); i++)
+      {
+        stored[i].store(totals.trials(i));
+      }
+      emitted.store(0);
+      live.store(w_count);
+      ckpt_time = 0;
+    }
+
+    //DESTRUCTOR
+    ~SweepPipeline()
+    {
+      delete todo;
+      delete done;
+      delete []stored;
+    }
+
+    //RUN
+    //Description: Runs trials until every percent is done or the sweep is
+    //interrupted. Scenarios generated before an interrupt are still finished,
+    //so the totals and the result file always hold whole trials.
+    void run()
+    {
+      vector<thread> pool;
+      pool.push_back(thread(&SweepPipeline::generate, this));
+      for (int w = 0; w < w_count; w++)
+      {
+        pool.push_back(thread(&SweepPipeline::work, this));
+      }
+      aggregate();
+      for (unsigned int w = 0; w < pool.size(); w++)
+      {
+        pool[w].join();
+      }
+      return;
+    }
+
+    //ACCESSOR FUNCTIONS
+    double getCkptTime(){return ckpt_time;}
+
+  private:
+    SweepSettings & sweep; //Settings of the sweep
+    Network<int> & base; //Undamaged Network
+    int max_flow; //Flow of the undamaged Network
+    SweepTotals & totals; //Written by the aggregator only
+    ResultWriter & out; //Written by the aggregator only
+    int w_count; //Number of worker threads
+    int window; //Most scenarios in flight at once
+    RingQueue<SweepTask<Cap> >* todo; //Tasks waiting for a worker
+    RingQueue<SweepScenario<Cap>*>* done; //Finished scenarios, any order
+    atomic<uint64_t>* stored; //Trials stored for each percent
+    atomic<uint64_t> emitted; //Scenarios stored so far
+    atomic<int> live; //Workers still running
+    double ckpt_time; //Seconds spent saving checkpoints
+
+    //ISSUED DONE
+    //Description: Returns true if no trials past the first n are needed for
+    //the sweep's i-th percent. An adaptive sweep can only tell at the end of
+    //a batch, once its trials are stored.
+    bool issuedDone(const int i, const uint64_t n)
+    {
+      if (n >= static_cast<uint64_t>(sweep.trials))
+      {
+        return true;
+      }
+      if (sweep.target <= 0 || n < ADAPT_MIN || n % sweep.getBatch() != 0)
+      {
+        return false;
+      }
+      for (int k = 0; stored[i].load(memory_order_acquire) < n; k++)
+      {
+        backoff(k);
+      }
+      return percentDone(sweep, totals, i);
+    }
+
+    //GENERATE
+    //Description: Generator stage. Each trial reseeds rand() with its own
+    //seed before the Network is damaged, so the scenarios do not depend on
+    //the order in which the stages run.
+    void generate()
+    {
+      int batch = sweep.getBatch(); //Trials per percent in each round
+      vector<uint64_t> issued(sweep.getPC()); //Trials generated per percent
+      uint64_t order = 0; //Scenarios generated so far
+      uint64_t round = ULLONG_MAX; //Current round
+      for (int i = 0; i < sweep.getPC(); i++) //Finds the round to resume
       {
-        x = v_node[i].getXP();
-        y = v_node[i].getYP();
-        radq = ((b_x - x)*(b_x - x) + (b_y - y)*(b_y - y));
-        if (rmax < radq)
+        issued[i] = totals.trials(i);
+        if (!issuedDone(i, issued[i]))
         {
-          rmax = radq;
+          round = min(round, issued[i] / batch);
         }
       }
-      /*-----BREAKING PHASE-----*/
-      int temp = 0; //Stores distance from barycenter, squared
-      for (int i = 0; i < node_count; i++)
+      for (; round != ULLONG_MAX && !interrupted; round++)
       {
-        x = v_node[i].getXP();
-        y = v_node[i].getYP();
-        temp = ((b_x - x)*(b_x - x) + (b_y - y)*(b_y - y));
-        if (temp < ((percent/100)*rmax))
+        bool active = false; //True if any percent may need more trials
+        for (int i = 0; i < sweep.getPC() && !interrupted; i++)
+        {
+          int p = sweep.p_from + i*sweep.p_step;
+          uint64_t end = min((round + 1) * batch,
+                             static_cast<uint64_t>(sweep.trials));
+          if (issuedDone(i, issued[i]))
+          {
+            continue;
+          }
+          while (issued[i] < end && !interrupted)
+          {
+            for (int k = 0; order - emitted.load() >=
+                            static_cast<uint64_t>(window); k++)
+            {
+              backoff(k);
+            }
+            SweepScenario<Cap>* s = new SweepScenario<Cap>(base);
+            s->order = order++;
+            s->trial = i*static_cast<uint64_t>(sweep.trials) + issued[i];
+            s->seed = trialSeed(sweep.seed, s->trial);
+            s->index = i;
+            s->percent = p;
+            srand(s->seed);
+            if (sweep.mode) //Random Failure
+            {
+              s->damaged.randomFail(p);
+            }
+            else //Geographical Failure
+            {
+              s->damaged.geoFail(p);
+            }
+            s->events.plan(s->damaged, sweep.shocks, p,
+                           s->damaged.assessDamage());
+            s->r_seed = rand();
+            for (int pol = 0; pol < POLICIES; pol++)
+            {
+              SweepTask<Cap> task = {s, pol};
+              todo->push(task);
+            }
+            issued[i]++;
+          }
+          if (issued[i] < static_cast<uint64_t>(sweep.trials))
+          {
+            active = true;
+          }
+        }
+        if (!active)
         {
-          v_node[i].broken = true;
-          nodes_broken++;
+          break;
         }
       }
-      for (int i = 0; i < link_count; i++)
+      for (int w = 0; w < w_count; w++)
+      {
+        SweepTask<Cap> stop = {NULL, -1};
+        todo->push(stop);
+      }
+      return;
+    }
+
+    //WORK
+    //Description: Worker stage. RandomRepair draws from its own generator,
+    //seeded by the scenario, so no two workers share one. GainRepair uses a
+    //single thread, since the pool already keeps every core busy. Tasks are
+    //taken in the order they were queued, so once the last worker stops, all
+    //scenarios have been passed on, and the aggregator is told to stop.
+    void work()
+    {
+      RandomRepair randPolicy;
+      GreedyRepair algPolicy;
+      GainRepair<Cap> gainPolicy(1);
+      SweepTask<Cap> task = todo->pop();
+      for (; task.scn != NULL; task = todo->pop())
       {
-        x = v_link[i].getMX();
-        y = v_link[i].getMY();
-        temp = ((b_x - x)*(b_x - x) + (b_y - y)*(b_y - y));
-        if (temp < ((percent/100)*rmax))
+        SweepScenario<Cap>* s = task.scn;
+        int pol = task.policy;
+        if (pol == POLICY_RANDOM)
+        {
+          randPolicy.reseed(s->r_seed);
+          s->avg[pol] = runTrial(s->damaged, s->events, randPolicy, max_flow,
+                                 s->flow[pol], s->when[pol]);
+        }
+        else if (pol == POLICY_GREEDY)
+        {
+          s->avg[pol] = runTrial(s->damaged, s->events, algPolicy, max_flow,
+                                 s->flow[pol], s->when[pol]);
+        }
+        else
+        {
+          s->avg[pol] = runTrial(s->damaged, s->events, gainPolicy, max_flow,
+                                 s->flow[pol], s->when[pol]);
+        }
+        if (s->left.fetch_sub(1, memory_order_acq_rel) == 1) //Last policy
         {
-          v_link[i].broken = true;
-          links_broken++;
+          done->push(s);
         }
       }
-      connect();
+      if (live.fetch_sub(1) == 1) //Last worker
+      {
+        done->push(NULL);
+      }
       return;
     }
 
-};
-  
-    
+    //AGGREGATE
+    //Description: Aggregator stage. Finished scenarios wait in a buffer of
+    //window slots, indexed by their order, until all earlier ones are
+    //stored.
+    void aggregate()
+    {
+      typedef chrono::steady_clock timer;
+      timer::time_point last_ckpt = timer::now();
+      vector<SweepScenario<Cap>*> ready(window, NULL); //Reorder buffer
+      SweepScenario<Cap>* s = done->pop();
+      for (; s != NULL; s = done->pop())
+      {
+        ready[s->order % window] = s;
+        uint64_t next = emitted.load();
+        while ((s = ready[next % window]) != NULL && s->order == next)
+        {
+          ready[next % window] = NULL;
+          store(s);
+          delete s;
+          emitted.store(++next);
+        }
+        if (!out.isGood()) //Stops the sweep, as an interrupt does
+        {
+          interrupted = 1;
+        }
 
-///////////////////////////////////////////////////////////////////////////////
-//////////////////////////////GENERAL FUNCTIONS////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////
+        /*-----PERIODIC CHECKPOINT-----*/
+        timer::time_point now = timer::now();
+        if (now - last_ckpt >= chrono::seconds(CKPT_SECONDS))
+        {
+          saveCheckpoint(sweep, totals, out);
+          last_ckpt = timer::now();
+          ckpt_time += chrono::duration<double>(last_ckpt - now).count();
+        }
+      }
+      return;
+    }
 
-//BREADTH FIRST SEARCH
-//Description: Special version of BFS used in conjuction with the
-//following Max-Flow-Calculating Algorithm.
-bool bfs(int** RG, int s, int t, int* parent, int nodes)
-{
-  queue<int> Q; //Storage queue
-  Q.push(s); //Push starting node into queue
-  bool* visited = new bool[nodes]; //Stores "visited" status on all nodes
-  for (int i = 0; i < nodes; i++) //Set all visited[] -> 0
-  {
-    visited[i] = false;
-  }
-  visited[s] = true;
-  parent[s] = -1; //"NIL"
-  while (Q.empty() == false) //While Q is not empty
-  {
-    int u = Q.front();
-    Q.pop();
-    for (int v = 0; v < nodes; v++)
+    //STORE
+    //Description: Appends the results of a scenario to the result file and
+    //the totals.
+    void store(SweepScenario<Cap>* s)
     {
-      if (!visited[v] && RG[u][v] > 0)
+      int i = s->index;
+      for (int pol = 0; pol < POLICIES; pol++)
+      {
+        for (int k = 0; k < ITV+1; k++)
+        {
+          out.append(s->trial, s->seed, sweep.mode, s->percent, pol,
+                     s->when[pol][k], s->flow[pol][k]);
+        }
+        totals.add(i*POLICIES + pol, s->avg[pol]);
+      }
+      totals.addDiff(i, s->avg[POLICY_GREEDY] - s->avg[POLICY_RANDOM]);
+      stored[i].store(totals.trials(i), memory_order_release);
+      if (percentDone(sweep, totals, i))
       {
-        Q.push(v);
-        parent[v] = u;
-        visited[v] = true;
+        cout << "Percent " << s->percent << " completed after "
+             << totals.trials(i) << " trials." << endl;
       }
+      return;
     }
-  }
-  bool storage = visited[t];
-  delete []visited;
-  return storage;
-}
+};
 
-//FORD FULKERSON'S MAX FLOW CALCULATOR
-//Description: Used to calculate Max Flow. Based off of the Ford
-//Fulkerson Algorithm; this particular implementation is known as the
-//Edmonds-Karp Algorithm.
-int calcMaxFlow(int** graph, int s, int t, int nodes)
+//RUN SWEEP
+//Description: Runs the trials of the sweep with all policies, and appends
+//the results to the sweep's result file. The Network is parsed again with
+//the sweep's seed, and each trial reseeds rand() with its own seed before the
+//Network is damaged, so a sweep can be repeated exactly.
+//Trials are run in rounds. Each round runs one batch of trials for every
+//percent that is not done yet. Fixed sweeps use a single batch of all their
+//trials, while adaptive sweeps use batches of ADAPT_BATCH trials, so their
+//work goes to the percents whose results vary the most.
+//The trials are run by a SweepPipeline, so the policies of a trial are
+//simulated at the same time as each other and as the next trials' setup.
+//A checkpoint is saved every CKPT_SECONDS and when the sweep is interrupted.
+//If resume is true, the sweep continues from its checkpoint, and its result
+//file ends up identical to the file of an uninterrupted sweep. If the result
+//file can not be written, the sweep stops and keeps its last checkpoint.
+//Returns false if the sweep failed.
+template <class Cap>
+bool runSweep(SweepSettings & sweep, const bool resume)
 {
-  int max_flow = 0; //Max calculated flow
-  int u = 0;
-  int v = 0;
-
-  int** RG = new int*[nodes]; //Stores Residual Graph
-  for (int i = 0; i < nodes; i++) //Create 2D Array
+  srand(sweep.seed);
+  Network<int> base;
+  parseGML(base);
+  base.reduce(SRCID, DSTID);
+  int max_flow = base.flow(SRCID, DSTID);
+  ResultWriter out(sweep.file);
+  if (!out.isGood())
   {
-    RG[i] = new int[nodes];
+    cout << "Error, could not open " << sweep.file
+         << " or it is shorter than its header says." << endl;
+    return false;
   }
-  for (u = 0; u < nodes; u++) //Copy original graph into RG
+  SweepTotals totals;
+  totals.reset(sweep.getPC());
+  if (resume && !loadCheckpoint(sweep.file, sweep, &totals, &out))
   {
-    for (v = 0; v < nodes; v++)
-    {
-      RG[u][v] = graph[u][v];
-    }
+    cout << "Error, could not resume from " << checkpointName(sweep.file)
+         << endl;
+    return false;
   }
-  int* parent = new int[nodes]; //Array to store parent nodes
-
-  /*-----MAX FLOW CALCULATION-----*/
-  while (bfs(RG, s, t, parent, nodes))
+  typedef chrono::steady_clock timer;
+  timer::time_point start = timer::now();
+  interrupted = 0;
+  signal(SIGINT, onInterrupt);
+  SweepPipeline<Cap> pipeline(sweep, base, max_flow, totals, out);
+  pipeline.run();
+  double ckpt_time = pipeline.getCkptTime(); //Seconds spent on checkpoints
+  signal(SIGINT, SIG_DFL);
+  double run_time =
+    chrono::duration<double>(timer::now() - start).count();
+  if (out.isGood() && interrupted)
   {
-    int path_flow = INT_MAX;
-    for (v = t; v != s; v = parent[v])
-    {
-      u = parent[v];
-      path_flow = min(path_flow, RG[u][v]);
-    }
-    for (v = t; v != s; v = parent[v])
-    {
-      u = parent[v];
-      RG[u][v] -= path_flow;
-      RG[v][u] += path_flow;
-    }
-    max_flow += path_flow;
+    saveCheckpoint(sweep, totals, out);
+    cout << "Sweep interrupted. Resume it with mode 4." << endl;
+    return true;
   }
-
-  /*-----MEMORY CLEANUP-----*/
-  for (int i = 0; i < nodes; i++)
+  out.flush();
+  if (!out.isGood()) //The last checkpoint, if any, is kept
   {
-    delete []RG[i];
+    cout << "Error, could not write " << sweep.file << endl;
+    return false;
   }
-  delete []RG;
-  delete []parent;
-  return max_flow;
-}
+  remove(checkpointName(sweep.file).c_str());
 
-//PARSING FUNCTION
-//Description: Reads from the input file, and creates the actual network.
-//Must contain at least two nodes and one edge.
-void parseGML(Network & comm_net)
-{
-  string storage = "empty"; //Storage string
-  Node* temp_node; //Pointer to Node
-  Link* temp_link; //Pointer to Link
-  bool lcv = true; //Boolean to control loops
-  ifstream fin;
-  fin.open(FILENAME.c_str());
-  /*-----SEARCH FOR START OF NODE LIST-----*/
-  while(storage != "node") //When "node" is read, the node list has begun
+  /*-----OUTPUT-----*/
+  uint64_t total = 0; //Trials run for all percents
+  for (int i = 0; i < sweep.getPC(); i++)
   {
-    fin >> storage;
+    total += totals.trials(i);
   }
-  /*-----BEGIN FORMING NODES-----*/
-  float x = 0; //Stores Latitude
-  float y = 0; //Stores Longitude
-  while(storage != "edge") //When "edge is read", the edge list has begun
+  cout << out.getRows() << " rows stored in " << sweep.file << endl;
+  cout << "Trials: " << total << " of " << sweep.getTC() << endl;
+  if (run_time > 0)
   {
-    while(storage != "Longitude" && lcv)
-    {
-      fin >> storage;
-      if (storage == "hyperedge")
-      {
-        lcv = false;
-      }
-    }
-    if(lcv)
-    {
-      fin >> y;
-    }
-    while(storage != "Latitude" && lcv)
-    {
-      fin >> storage;
-    }
-    if (storage != "Latitude") //Hyperedges do not have coordinates.
-    { //So, a generic coordinate near the center of the system is used.
-      x = 40;
-      y = -90;
-    }
-    else
-    {
-      fin >> x;
-    }
-    temp_node = new Node(x,y);
-    comm_net.v_node.push_back(*temp_node);
-    comm_net.node_count++;
-    delete temp_node;
-    temp_node = NULL;
-    lcv = true;
-    while(storage != "node" && storage != "edge")
-    {
-      fin >> storage;
-    }
+    cout << "Checkpoint Overhead: " << 100 * ckpt_time / run_time << "%"
+         << endl;
   }
-
-  //*-----ADJACENCY MATRIX CREATION-----*/
-  comm_net.AM = new int*[comm_net.node_count];
-  for (int i = 0; i < comm_net.node_count; i++)
+  cout << "Average Flow per Percent:" << endl << "(Percent,Trials";
+  for (int pol = 0; pol < POLICIES; pol++)
   {
-    comm_net.AM[i] = new int[comm_net.node_count];
-    for (int j = 0; j < comm_net.node_count; j++)
-    {
-      comm_net.AM[i][j] = 0;
-    }
+    cout << "," << POLICY_TAG[pol];
   }
-
-  /*-----BEGIN FORMING LINKS-----*/
-  int s = 0; //Stores Link's first node
-  int e = 0; //Stores Link's other node
-  x = 0;
-  y = 0;  
-  while(lcv)
+  cout << ",A-R,CI Width)" << endl;
+  for (int i = 0; i < sweep.getPC(); i++)
   {
-    while(storage != "edge")
-    {
-      fin >> storage;
-    }
-    while(storage != "source")
-    {
-      fin >> storage;
-    }
-    fin >> s;
-    while(storage != "target")
+    cout << "(" << sweep.p_from + i*sweep.p_step << "," << totals.trials(i);
+    for (int pol = 0; pol < POLICIES; pol++)
     {
-      fin >> storage;
+      cout << "," << totals.mean(i*POLICIES + pol);
     }
-    fin >> e;
+    cout << "," << totals.d_sum[i] / max<uint64_t>(1, totals.trials(i))
+         << "," << totals.width(i) << ")" << endl;
+  }
+  return true;
+}
 
-    /*-----CALCULATE X AND Y FOR LINK-----*/
-    x = (comm_net.v_node[s].getXP() + comm_net.v_node[e].getXP())/2;
-    y = (comm_net.v_node[s].getYP() + comm_net.v_node[e].getYP())/2;
-    temp_link = new Link(s,e,x,y); //Start, End, X-Coord, Y-Coord.
-    comm_net.v_link.push_back(*temp_link);
-    comm_net.link_count++;
-    comm_net.AM[s][e] = temp_link->getCAP();
-    comm_net.AM[e][s] = temp_link->getCAP();
-    delete temp_link;
-    temp_link = NULL;
-    while(storage != "]")
+//RUN MODE
+//Description: Runs the selected mode with capacities stored as Cap. path is
+//the service's socket, or "-" to serve stdin. Returns false if the mode
+//failed.
+template <class Cap>
+bool runMode(Network<int> & comm_net, const int mode, const int max_flow,
+             const int percent, const int shocks, SweepSettings & sweep,
+             const string path)
+{
+  if (mode == 2 || mode == 4)
+  {
+    return runSweep<Cap>(sweep, mode == 4);
+  }
+  else if (mode == 5)
+  {
+    Network<Cap> served(comm_net);
+    NetworkService<Cap> service(served);
+    if (path == "-")
     {
-      fin >> storage;
+      service.serveStdin();
     }
-    fin >> storage;
-    if (storage == "]")
+    else if (!service.serveSocket(path))
     {
-      lcv = false;
+      cerr << "Error, could not listen on " << path << endl;
+      return false;
     }
   }
-
-  /*-----CALCULATE BARYCENTER-----*/
-  float bary_x = 0;
-  float bary_y = 0;
-  for (int i = 0; i < comm_net.getNC(); i++)
+  else
   {
-    bary_x += comm_net.v_node[i].getXP();
-    bary_y += comm_net.v_node[i].getYP();
+    runExperiment<Cap>(comm_net, max_flow, percent, shocks);
   }
-  comm_net.b_x = bary_x / comm_net.getNC();
-  comm_net.b_y = bary_y / comm_net.getNC();
-  fin.close();
-  return;
+  return true;
 }
 
-//RANDOM REPAIR
-//Description: Implementation of Random Algorithm. Schedules a random broken
-//component for repairs if no other components are currently being repaired.
-void randomRepair(Network & comm_net)
+//PRINT SUMMARY
+//Description: Prints the statistics of a result file, and the average flow
+//of every policy for each failure mode and percent in it.
+void printSummary(const string name)
 {
-  if (comm_net.RRT != 0)
+  ResultReader in(name);
+  if (in.header == NULL)
   {
+    cout << "Error, " << name << " is not a readable result file." << endl;
     return;
   }
-  else //The network is not currently repairing anything else
+  ResultHeader & h = *in.header;
+  cout << "Rows: " << h.rows << " in " << h.blocks << " blocks" << endl;
+  if (h.rows == 0)
   {
-    if (comm_net.LR || comm_net.NR || comm_net.SR)
-    {
-      comm_net.progress(); //Completes scheduled repair
-    }
-    int repair_count = -1; //Stores amount of repairs to be made
-    repair_count = comm_net.getNB() + comm_net.getLB();
-    int midpoint = comm_net.getNB();
-    if (repair_count == 0) //No repairs are necessary
-    {
-      return;
-    }
-    int selection = (rand()%repair_count)+1;
-    bool searching = true; //Controls loops that search for broken component
-    if (selection <= midpoint) //A node will be repaired
-    {
-      while(searching)
-      {
-        selection = (rand()%comm_net.getNC());
-        if (comm_net.v_node[selection].broken == true)
-        {
-          comm_net.repairNode(selection); //Schedule Node Repair
-          searching = false;
-        }
-      }
-    }
-    else //A link will be repaired
+    return;
+  }
+  double mean = static_cast<double>(h.flow_sum) / h.rows;
+  cout << "Average Flow: " << mean << " (min " << h.flow_min << ", max "
+       << h.flow_max << ", std. dev. "
+       << sqrt(max(0.0, h.flow_sq / h.rows - mean*mean)) << ")" << endl;
+  for (int pol = 0; pol < POLICIES; pol++)
+  {
+    if (h.p_rows[pol] > 0)
     {
-      while(searching)
-      {
-        selection = (rand()%comm_net.getLC());
-        if (comm_net.v_link[selection].broken == true)
-        {
-          comm_net.repairLink(selection); //Schedule Link Repair
-          searching = false;
-        }
-      }
+      cout << POLICY_NAME[pol] << " Algorithm's Average Flow: "
+           << static_cast<double>(h.p_flow[pol]) / h.p_rows[pol] << endl;
     }
-    return;
   }
-}
 
-//ALGORITHM REPAIR
-//Description: Implementation of the Algorithm designed in the report.
-//The "ERV" for some Link is the ratio formed by the capacity of the link
-//divided by the time to repair the link and the two nodes tied to it.
-//If the link or either of the nodes are already functional, then their
-//repair time is not added into this ratio.
-void algorithmicRepair(Network & comm_net)
-{
-  if (comm_net.RRT != 0)
+  /*-----PER PERCENT AVERAGES-----*/
+  vector<int64_t> sum;
+  vector<uint64_t> count;
+  in.cellTotals(sum, count);
+  cout << endl << "(Mode,Percent";
+  for (int pol = 0; pol < POLICIES; pol++)
   {
-    return;
+    cout << "," << POLICY_TAG[pol];
   }
-  else //The network is not currently repairing anything else
+  cout << ")" << endl;
+  for (int m = 0; m < 2; m++)
   {
-    if (comm_net.LR || comm_net.NR || comm_net.SR)
-    {
-      comm_net.progress(); //Completes scheduled repair
-    }
-    int repair_count = comm_net.getNB() + comm_net.getLB();
-    if (repair_count == 0) //No repairs are necessary
-    {
-      return;
-    }
-    float temp_ERV = 0;
-    float max_ERV = -1;
-    float duration = -1;
-    int ERV_index = -1;
-    for (int l = 0; l < comm_net.getLC(); l++)
+    for (int p = 0; p < 256; p++)
     {
-      if (comm_net.v_link[l].connected == false)
+      int cell = (m*256 + p)*MAX_POLICIES;
+      bool found = false;
+      for (int pol = 0; pol < POLICIES; pol++)
       {
-        duration = comm_net.calcSRT(l);
-        temp_ERV = (static_cast<float>(comm_net.v_link[l].getCAP())/duration);
-        if (temp_ERV > max_ERV)
+        found = found || count[cell + pol] > 0;
+      }
+      if (found)
+      {
+        cout << "(" << m << "," << p;
+        for (int pol = 0; pol < POLICIES; pol++)
         {
-          max_ERV = temp_ERV;
-          ERV_index = l;
+          cout << "," << (count[cell + pol] == 0 ? 0 :
+                  static_cast<double>(sum[cell + pol]) / count[cell + pol]);
         }
+        cout << ")" << endl;
       }
     }
-    comm_net.smartRepair(ERV_index);
-    return;
   }
+  return;
 }
 
 
@@ -770,111 +4276,132 @@ void algorithmicRepair(Network & comm_net)
 
 int main()
 {
+  ios::sync_with_stdio(false); //Lets the network service take cin's buffer
   srand(time(NULL));
-  Network randNet;
+  Network<int> randNet;
   parseGML(randNet);
-  int max_flow = calcMaxFlow(randNet.AM, SRCID, DSTID, randNet.getNC());
-  cout << "Initial Flow: " << max_flow << endl << endl;
+  randNet.reduce(SRCID, DSTID);
+  int max_flow = randNet.flow(SRCID, DSTID);
+  //The menu and prompts go to cerr, so that cout only carries results. In
+  //the network service, cout carries nothing but replies, so the initial
+  //flow is printed once the mode is known.
   
   /*-----MODE SELECTION-----*/
-  bool mode = true; //Used to determine geographical or random failure
-  cout << "Select Mode: (0) Geographical Failure, (1) Random Failure" << endl;
-  cout << "Mode: ";
+  int mode = 1; //Used to determine geographical or random failure, or a sweep
+  cerr << "Select Mode: (0) Geographical Failure, (1) Random Failure," << endl;
+  cerr << "             (2) Failure Sweep, (3) Sweep Summary," << endl;
+  cerr << "             (4) Resume Sweep, (5) Network Service" << endl;
+  cerr << "Mode: ";
   cin >> mode;
-  int PROB = 0; //Stores Probability
-  if (mode) //Random Failure Selected
+  if (mode != 5)
   {
-    cout << endl << "Enter Percent Failure Rate: ";
-    cout << endl << "Percent: ";
-    cin >> PROB;
-    randNet.randomFail(PROB);
+    cout << "Initial Flow: " << max_flow << endl;
+    cout << "Reduced Network: " << randNet.reduced->r_count << " of "
+         << randNet.getNC() << " nodes" << endl << endl;
   }
-  else //Geographical Failure Selected
+  int PROB = 0; //Stores Probability
+  int SHOCKS = 0; //Stores number of aftershocks
+  SweepSettings sweep; //Stores sweep parameters
+  string path; //Socket of the network service
+  if (mode == 3) //Sweep Summary Selected
   {
-    cout << endl << "Enter Percent of Diameter Destroyed: ";
-    cout << endl << "Percent: ";
-    cin >> PROB;
-    randNet.geoFail(PROB);
+    string name;
+    cerr << endl << "Enter Result File: ";
+    cin >> name;
+    cerr << endl;
+    printSummary(name);
+    return 0;
   }
-  Network algNet(randNet); //Creates Duplicate Network
-  cout << endl;
-  
-  /*-----EXPERIMENTS-----*/
-  int clock = 0; //Stores time passed
-  int rec_c = 0; //Stores number of recorded values
-  int est_t = randNet.assessDamage(); //Stores time to recover full network
-  int* RNflow = new int[ITV+1]; //Stores Random Algorithm Flow Measurements
-  int* ANflow = new int[ITV+1]; //Stores Greedy Algorithm flow Measurements
-  for (int i = 0; i < ITV+1; i++) //Fills out initial flow values
+  else if (mode == 5) //Network Service Selected
   {
-    RNflow[i] = max_flow; //Default flow is optimal
-    ANflow[i] = max_flow; //Default flow is optimal
+    cerr << endl << "Enter Socket Path (- for stdin): ";
+    cin >> path;
   }
-
-  //RANDOM ALGORITHM TESTING PHASE
-  while(randNet.assessDamage() != 0)
+  else if (mode == 4) //Resume Sweep Selected
   {
-    randomRepair(randNet);
-    if (randNet.RRT > 0) //If there are still repairs left
-    {
-      randNet.RRT--;
-    }
-    if (clock == (rec_c*(est_t/(ITV)))) //If an interval was reached
+    string name;
+    cerr << endl << "Enter Result File: ";
+    cin >> name;
+    if (!loadCheckpoint(name, sweep, NULL, NULL))
     {
-      RNflow[rec_c] = calcMaxFlow(randNet.AM, SRCID, DSTID, randNet.getNC());
-      //Record data values
-      rec_c++;
-    }    
-    if (randNet.assessDamage() == 0) //Stores last values
-    {
-      RNflow[ITV] = calcMaxFlow(randNet.AM, SRCID, DSTID, randNet.getNC());
+      cerr << endl << "Error, no checkpoint found for " << name << endl;
+      return 1;
     }
-    clock++;
   }
-
-  //GREEDY ALGORITHM TESTING PHASE
-  clock = 0; //Reset
-  rec_c = 0; //Reset
-  while(algNet.assessDamage() != 0)
+  else if (mode == 2) //Failure Sweep Selected
   {
-    algorithmicRepair(algNet);
-    if (algNet.RRT > 0) //If there are still repairs left
+    cerr << endl << "Enter Failure Mode: (0) Geographical, (1) Random";
+    cerr << endl << "Failure Mode: ";
+    cin >> sweep.mode;
+    sweep.mode = (sweep.mode != 0);
+    cerr << endl << "Enter Percents: First, Last, and Step";
+    cerr << endl << "Percents: ";
+    cin >> sweep.p_from >> sweep.p_to >> sweep.p_step;
+    sweep.p_from = min(100, max(0, sweep.p_from));
+    sweep.p_to = min(100, sweep.p_to);
+    sweep.p_step = max(1, sweep.p_step);
+    if (sweep.p_from > sweep.p_to)
     {
-      algNet.RRT--;
+      cerr << endl << "Error, the first percent is above the last" << endl;
+      return 1;
     }
-    if (clock == (rec_c*(est_t/(ITV)))) //If an interval was reached
+    cerr << endl << "Enter Trials per Percent (the limit, if adaptive): ";
+    cin >> sweep.trials;
+    sweep.trials = max(1, sweep.trials);
+    cerr << endl << "Enter Confidence Interval Width (0 for fixed trials): ";
+    cin >> sweep.target;
+    cerr << endl << "Enter Aftershocks per Trial: ";
+    cin >> sweep.shocks;
+    cerr << endl << "Enter Seed (0 for current time): ";
+    cin >> sweep.seed;
+    if (sweep.seed == 0)
     {
-      ANflow[rec_c] = calcMaxFlow(algNet.AM, SRCID, DSTID, algNet.getNC());
-      //Record data values
-      rec_c++;
-    }
-    if (algNet.assessDamage() == 0) //Stores last values
-    {
-      ANflow[ITV] = calcMaxFlow(algNet.AM, SRCID, DSTID, algNet.getNC());
+      sweep.seed = time(NULL);
     }
-    clock++;
+    cerr << endl << "Enter Result File: ";
+    cin >> sweep.file;
   }
-  
-  /*-----OUTPUT-----*/
-  float avgR = 0;
-  float avgA = 0;
-  cout << "Flow Analysis: " << endl;
-  cout << "(R,A)" << endl;
-  for (int i = 0; i <= ITV; i++)
+  else if (mode) //Random Failure Selected
   {
-    cout << "(" << RNflow[i] << "," << ANflow[i] << ")" << endl;
-    avgR += RNflow[i];
-    avgA += ANflow[i];
+    cerr << endl << "Enter Percent Failure Rate: ";
+    cerr << endl << "Percent: ";
+    cin >> PROB;
+    randNet.randomFail(PROB);
+    cerr << endl << "Enter Number of Aftershocks: ";
+    cin >> SHOCKS;
   }
-  avgR /= (ITV+1);
-  avgA /= (ITV+1);
-  cout << "Random Algorithm's Average Flow: " << avgR << endl;
-  cout << "Greedy Algorithm's Average Flow: " << avgA << endl;
+  else //Geographical Failure Selected
+  {
+    cerr << endl << "Enter Percent of Diameter Destroyed: ";
+    cerr << endl << "Percent: ";
+    cin >> PROB;
+    randNet.geoFail(PROB);
+    cerr << endl << "Enter Number of Aftershocks: ";
+    cin >> SHOCKS;
+  }
+  cerr << endl;
 
-  /*-----DATA CLEANUP-----*/
-  delete []ANflow;
-  delete []RNflow;
-  return 0;
+  /*-----CAPACITY TYPE SELECTION-----*/
+  //The smallest integer type that can hold every residual capacity is used,
+  //which keeps the flow calculations' matrices as small as possible.
+  int bound = randNet.capacityBound();
+  bool ran = false; //False if the mode failed
+  if (bound <= UCHAR_MAX)
+  {
+    ran = runMode<unsigned char>(randNet, mode, max_flow, PROB, SHOCKS, sweep,
+                                 path);
+  }
+  else if (bound <= USHRT_MAX)
+  {
+    ran = runMode<unsigned short>(randNet, mode, max_flow, PROB, SHOCKS,
+                                  sweep, path);
+  }
+  else
+  {
+    ran = runMode<int>(randNet, mode, max_flow, PROB, SHOCKS, sweep,
+                       path);
+  }
+  return ran ? 0 : 1;
 }
 
 